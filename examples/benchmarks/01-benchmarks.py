@@ -0,0 +1,28 @@
+import time
+
+import stormpy
+
+import stormpy.examples
+import stormpy.examples.files
+
+
+def example_benchmarks_01():
+    # Compare multiply-and-reduce on the sparse matrix and on the sliced sparse matrix
+    path = stormpy.examples.files.prism_mdp_coin_2_2
+    prism_program = stormpy.parse_prism_program(path)
+    model = stormpy.build_model(prism_program)
+    matrix = model.transition_matrix
+
+    start = time.perf_counter()
+    sliced = stormpy.SlicedSparseMatrix(matrix)
+    conversion_time = time.perf_counter() - start
+    print("Converted matrix with {} entries ({} incl. padding) in {:.4f}s".format(sliced.nr_entries, sliced.nr_padded_entries, conversion_time))
+
+    repetitions = 1000
+    sparse_time, sliced_time = stormpy.storage._benchmark_multiply_and_reduce(matrix, sliced, stormpy.OptimizationDirection.Maximize, repetitions)
+    print("Sparse matrix: {:.4f}s for {} iterations".format(sparse_time, repetitions))
+    print("Sliced matrix: {:.4f}s for {} iterations".format(sliced_time, repetitions))
+
+
+if __name__ == '__main__':
+    example_benchmarks_01()
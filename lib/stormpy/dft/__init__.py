@@ -26,6 +26,14 @@ def build_model(ft, symmetries=DftSymmetries(), relevant_events=RelevantEvents()
         return dft._build_model_ratfunc(ft, symmetries, relevant_events, allow_dc_for_relevant)
 
 
+def build_model_parallel(ft, symmetries=DftSymmetries(), relevant_events=RelevantEvents(), allow_dc_for_relevant=False, threads=0):
+    if isinstance(ft, DFT_double):
+        return dft._build_model_parallel_double(ft, symmetries, relevant_events, allow_dc_for_relevant, threads)
+    else:
+        assert isinstance(ft, DFT_ratfunc)
+        return dft._build_model_parallel_ratfunc(ft, symmetries, relevant_events, allow_dc_for_relevant, threads)
+
+
 def transform_dft(ft, unique_constant_be, binary_fdeps, exponential_distributions):
     if isinstance(ft, DFT_double):
         return dft._transform_dft_double(ft, unique_constant_be, binary_fdeps, exponential_distributions)
@@ -155,6 +155,26 @@ class DftSimulator:
         self.reset()
         return success
 
+    def simulate_batch(self, timebounds, nr_traces, seed=42, threads=0, confidence=0.95, forcing=False):
+        """
+        Simulate a number of traces via Monte Carlo simulation in parallel and estimate the unreliability for each time bound.
+        The result only depends on the seed and not on the number of threads.
+
+        :param timebounds: Time bound or list of time bounds.
+        :param nr_traces: The number of traces to simulate.
+        :param seed: Seed for the random number generators.
+        :param threads: Number of threads. 0 uses the number of hardware threads.
+        :param confidence: Confidence level of the confidence intervals.
+        :param forcing: Whether failures are forced to occur before the largest time bound (failure biasing). Improves the estimates for rare failures but requires exponential BEs.
+        :return: Result with estimated unreliability and confidence intervals for each time bound.
+        """
+        if not isinstance(timebounds, (list, tuple)):
+            timebounds = [timebounds]
+        info = self._dft.state_generation_info()
+        return stormpy.dft._simulate_batch_double(
+            self._dft, info, list(timebounds), nr_traces, seed=seed, threads=threads, confidence=confidence, forcing=forcing
+        )
+
     def reset(self):
         """
         Reset the simulator to the initial state.
@@ -1,4 +1,5 @@
 from . import pomdp
+from stormpy import StormError
 from .pomdp import *
 
 def make_canonic(model):
@@ -38,6 +39,21 @@ def unfold_memory(model, memory, add_memory_labels=False, keep_state_valuations=
     else:
         return pomdp._unfold_memory_Double(model, memory, add_memory_labels, keep_state_valuations)
 
+def unfold_memory_reachable(model, memory, add_memory_labels=False, threads=0):
+    """
+    Unfold the memory for an FSC into the POMDP, only building the product states which are reachable.
+    The product is constructed with multiple threads.
+
+    :param model: A pomdp
+    :param memory: A memory structure
+    :param add_memory_labels: Add a label for each memory state
+    :param threads: Number of threads, 0 for the number of hardware threads
+    :return: A ReachableMemoryProduct containing the product pomdp, the origins of the product states and the size reduction compared to the full product
+    """
+    if model.supports_parameters or model.is_exact:
+        raise StormError("Reachable memory unfolding is only supported for POMDPs with double values")
+    return pomdp._unfold_memory_reachable_Double(model, memory, add_memory_labels, threads)
+
 def apply_unknown_fsc(model, mode):
     if model.supports_parameters:
         return pomdp._apply_unknown_fsc_Rf(model, mode)
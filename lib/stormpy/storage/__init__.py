@@ -1,7 +1,12 @@
+import weakref
+
 import stormpy.utility
 from . import storage
 from .storage import *
 
+# Cache of state valuation tables per model
+_state_valuation_tables = weakref.WeakKeyDictionary()
+
 
 def build_sparse_matrix(array, row_group_indices=[]):
     """
@@ -67,6 +72,69 @@ def build_parametric_sparse_matrix(array, row_group_indices=[]):
     return builder.build()
 
 
+def build_sliced_matrix(matrix, index_bits=None, sorting_scope=None, value_bits=64):
+    """
+    Convert a sparse matrix into a sliced sparse matrix for fast matrix-vector multiplication.
+
+    :param matrix: Sparse matrix.
+    :param index_bits: Number of bits per index (32 or 64). If None, 32-bit indices are used whenever the matrix dimensions permit it.
+    :param sorting_scope: Size of the windows in which rows are sorted by length. If None, the default is used.
+    :param value_bits: Number of bits per value (32 for single precision or 64 for double precision).
+    :return: Sliced sparse matrix.
+    """
+    if value_bits == 64:
+        classes = (storage.SlicedSparseMatrix, storage.SlicedSparseMatrix64)
+    elif value_bits == 32:
+        classes = (storage.FloatSlicedSparseMatrix, storage.FloatSlicedSparseMatrix64)
+    else:
+        raise RuntimeError("Value size of {} bits is not supported.".format(value_bits))
+    if index_bits is None:
+        index_bits = 32 if classes[0].fits(matrix) else 64
+    if index_bits == 32:
+        sliced_class = classes[0]
+    elif index_bits == 64:
+        sliced_class = classes[1]
+    else:
+        raise RuntimeError("Index size of {} bits is not supported.".format(index_bits))
+    if sorting_scope is None:
+        return sliced_class(matrix)
+    return sliced_class(matrix, sorting_scope)
+
+
+def solve_min_max_equations_mixed_precision(matrix, direction, summand, initial_values, precision=1e-6, approximate_precision=1e-4, relative=True,
+                                            maximal_iterations=None, lower_bound=0.0, upper_bound=1.0):
+    """
+    Solve x = min/max (A*x + b) by value iteration in single precision followed by a refinement in double precision.
+    The single precision phase works on a sliced copy of the matrix and stops once the approximate precision is reached.
+    The refinement performs interval iteration on the original matrix, which maintains a lower and an upper bound on the solution.
+    It stops once the bounds differ by at most the precision, in which case the result is certified.
+    The bounds are sound if the given bounds enclose the solution and the solution is the unique fixed point within the given bounds.
+    This holds, e.g., if end components have been removed or the bounds fix the values of states in end components.
+    The default bounds are valid for probabilities.
+
+    :param matrix: Sparse matrix A with as many columns as row groups.
+    :param direction: Optimization direction.
+    :param summand: Vector b with one entry per row.
+    :param initial_values: Starting vector with one entry per row group.
+    :param precision: Precision for the difference between the upper and lower bounds.
+    :param approximate_precision: Precision of the single precision phase.
+    :param relative: Whether the precisions are relative.
+    :param maximal_iterations: Maximal number of iterations of both phases together. If None, the number is unbounded.
+    :param lower_bound: Lower bound on the solution, either a single value or one value per row group.
+    :param upper_bound: Upper bound on the solution, either a single value or one value per row group.
+    :return: Result containing the bounds, the error bound and the number of iterations in both phases.
+    """
+    solve = storage._solve_min_max_equations_mixed_precision
+    if not storage.FloatSlicedSparseMatrix.fits(matrix):
+        solve = storage._solve_min_max_equations_mixed_precision_index64
+    nr_groups = matrix.nr_columns
+    lower_bounds = [lower_bound] * nr_groups if isinstance(lower_bound, (int, float)) else lower_bound
+    upper_bounds = [upper_bound] * nr_groups if isinstance(upper_bound, (int, float)) else upper_bound
+    if maximal_iterations is None:
+        return solve(matrix, direction, summand, initial_values, lower_bounds, upper_bounds, precision, approximate_precision, relative)
+    return solve(matrix, direction, summand, initial_values, lower_bounds, upper_bounds, precision, approximate_precision, relative, maximal_iterations)
+
+
 def get_maximal_end_components(model):
     """
     Get maximal end components from model.
@@ -81,3 +149,82 @@ def get_maximal_end_components(model):
         return stormpy.MaximalEndComponentDecomposition_interval(model)
     else:
         return stormpy.MaximalEndComponentDecomposition_double(model)
+
+
+def get_strongly_connected_components(model, drop_naive_sccs=False, only_bottom_sccs=False):
+    """
+    Get strongly connected components from model.
+    :param model: Model.
+    :param drop_naive_sccs: If True, SCCs consisting of a single state without self-loop are omitted.
+    :param only_bottom_sccs: If True, only bottom SCCs are computed.
+    :return: Strongly connected components.
+    """
+    if model.supports_parameters:
+        return stormpy.StronglyConnectedComponentDecomposition_ratfunc(model, drop_naive_sccs, only_bottom_sccs)
+    elif model.is_exact:
+        return stormpy.StronglyConnectedComponentDecomposition_exact(model, drop_naive_sccs, only_bottom_sccs)
+    elif model.supports_uncertainty:
+        return stormpy.StronglyConnectedComponentDecomposition_interval(model, drop_naive_sccs, only_bottom_sccs)
+    else:
+        return stormpy.StronglyConnectedComponentDecomposition_double(model, drop_naive_sccs, only_bottom_sccs)
+
+
+def get_bottom_strongly_connected_components(model):
+    """
+    Get bottom strongly connected components from model.
+    :param model: Model.
+    :return: Bottom strongly connected components.
+    """
+    return get_strongly_connected_components(model, drop_naive_sccs=True, only_bottom_sccs=True)
+
+
+def get_maximal_end_components_parallel(model, threads=0):
+    """
+    Get maximal end components from model using multiple threads.
+    The decomposition is returned as flat arrays containing the component index of each state and each choice.
+    :param model: Model.
+    :param threads: Number of threads. If 0, the number of hardware threads is used.
+    :return: Decomposition result with arrays state_components and choice_components.
+    """
+    if model.supports_parameters:
+        return stormpy.parallel_maximal_end_components_ratfunc(model, threads)
+    elif model.is_exact:
+        return stormpy.parallel_maximal_end_components_exact(model, threads)
+    elif model.supports_uncertainty:
+        return stormpy.parallel_maximal_end_components_interval(model, threads)
+    else:
+        return stormpy.parallel_maximal_end_components_double(model, threads)
+
+
+def get_strongly_connected_components_parallel(model, threads=0):
+    """
+    Get strongly connected components from model using multiple threads.
+    The decomposition is returned as flat array containing the component index of each state.
+    :param model: Model.
+    :param threads: Number of threads. If 0, the number of hardware threads is used.
+    :return: Decomposition result with array state_components.
+    """
+    if model.supports_parameters:
+        return stormpy.parallel_strongly_connected_components_ratfunc(model, threads)
+    elif model.is_exact:
+        return stormpy.parallel_strongly_connected_components_exact(model, threads)
+    elif model.supports_uncertainty:
+        return stormpy.parallel_strongly_connected_components_interval(model, threads)
+    else:
+        return stormpy.parallel_strongly_connected_components_double(model, threads)
+
+
+def get_state_valuation_table(model):
+    """
+    Get the state valuations of the model in columnar form with one NumPy array per variable.
+    The table is computed once and cached for the model.
+    :param model: Model with state valuations.
+    :return: State valuation table.
+    """
+    table = _state_valuation_tables.get(model)
+    if table is None:
+        if not model.has_state_valuations():
+            raise RuntimeError("Model has no state valuations.")
+        table = storage.StateValuationTable(model.state_valuations)
+        _state_valuation_tables[model] = table
+    return table
@@ -34,6 +34,7 @@ class CMakeBuild(build_ext):
         ('disable-pars', None, 'Disable support for parametric models'),
         ('disable-pomdp', None, 'Disable support for POMDP analysis'),
         ('debug', None, 'Build in Debug mode'),
+        ('native-arch', None, 'Compile for the instruction set of the host machine'),
         ('jobs=', 'j', 'Number of jobs to use for compiling'),
         ('pybind-version=', None, 'Pybind11 version to use'),
     ]
@@ -129,6 +130,7 @@ class CMakeBuild(build_ext):
         cmake_args += ['-DUSE_STORM_GSPN=' + ('ON' if use_gspn else 'OFF')]
         cmake_args += ['-DUSE_STORM_PARS=' + ('ON' if use_pars else 'OFF')]
         cmake_args += ['-DUSE_STORM_POMDP=' + ('ON' if use_pomdp else 'OFF')]
+        cmake_args += ['-DSTORMPY_NATIVE_ARCH=' + ('ON' if self.config.get_as_bool("native_arch") else 'OFF')]
 
         # Configure extensions
         env = os.environ.copy()
@@ -168,6 +170,7 @@ class CMakeBuild(build_ext):
         self.disable_pars = None
         self.disable_pomdp = None
         self.debug = None
+        self.native_arch = None
         self.jobs = None
         self.pybind_version = None
 
@@ -183,6 +186,7 @@ class CMakeBuild(build_ext):
         self.config.update("disable_pars", self.disable_pars)
         self.config.update("disable_pomdp", self.disable_pomdp)
         self.config.update("debug", self.debug)
+        self.config.update("native_arch", self.native_arch)
         self.config.update("jobs", self.jobs)
         self.config.update("pybind_version", self.pybind_version)
 
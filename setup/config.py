@@ -33,6 +33,7 @@ class SetupConfig:
             "disable_pars": False,
             "disable_pomdp": False,
             "debug": False,
+            "native_arch": False,
             "jobs": str(no_jobs),
             "pybind_version": ""
         }
@@ -3,14 +3,486 @@
 #include "storm/environment/Environment.h"
 #include "storm-counterexamples/api/counterexamples.h"
 
+#include "storm/logic/Formulas.h"
+#include "storm/modelchecker/CheckTask.h"
+#include "storm/modelchecker/prctl/SparseMdpPrctlModelChecker.h"
+#include "storm/modelchecker/propositional/SparsePropositionalModelChecker.h"
+#include "storm/modelchecker/results/ExplicitQualitativeCheckResult.h"
+#include "storm/modelchecker/results/ExplicitQuantitativeCheckResult.h"
+#include "storm/models/sparse/Dtmc.h"
+#include "storm/models/sparse/Mdp.h"
+#include "storm/models/sparse/StandardRewardModel.h"
+#include "storm/storage/BitVector.h"
+#include "storm/storage/sparse/JaniChoiceOrigins.h"
+#include "storm/storage/sparse/PrismChoiceOrigins.h"
+#include "storm/utility/macros.h"
+#include "storm/exceptions/InvalidArgumentException.h"
+#include "storm/exceptions/NotSupportedException.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <queue>
+#include <thread>
+
 
 using namespace storm::counterexamples;
 
+using FlatSet = boost::container::flat_set<uint64_t, std::less<uint64_t>, boost::container::new_allocator<uint64_t>>;
+
+struct CriticalSubsystemResult {
+    storm::storage::BitVector states;
+    // Commands (Prism) or edges (Jani) of the choices in the subsystem. Empty if the model has no choice origins.
+    FlatSet labelSet;
+    // Probability of the subsystem, a lower bound unless converged is set
+    double probability = 0;
+    bool converged = false;
+    // Whether the probability exceeds the threshold, i.e., the subsystem is a counterexample
+    bool critical = false;
+    std::string heuristic;
+    double time = 0;
+};
+
+/*!
+ * Heuristic computation of critical subsystems for upper probability bounds P<=p [phi U psi] (or P<p).
+ * A critical subsystem is a set of states whose probability to reach psi (when all other states are made absorbing)
+ * exceeds the bound. For MDPs, the subsystem is computed for a maximizing scheduler, hence the choices of the scheduler
+ * in the subsystem form a counterexample.
+ * Several heuristics run in parallel until the time limit; the smallest critical subsystem found is returned.
+ * Smaller means fewer labels (if the model has choice origins), then fewer states.
+ * - greedy: sort states by the probability of the most probable path through them and take the smallest sufficient prefix.
+ * - local_search: start with the most probable path and repeatedly add the most probable path fragment which starts and
+ *   ends in the subsystem.
+ * Afterwards, states are removed from the found subsystem as long as it stays critical and time remains.
+ * Probabilities are computed by value iteration, which approaches the probability from below; hence a subsystem is only
+ * reported as critical if it is. During the search, value iteration stops as soon as the threshold is exceeded.
+ * The probability of the best subsystem is computed until convergence once the search is finished, unless the time
+ * limit is reached before; in that case, the lower bound from the search is kept.
+ * Only unbounded reachability and until formulas are supported.
+ */
+class CriticalSubsystemSearch {
+public:
+    CriticalSubsystemSearch(std::shared_ptr<storm::models::sparse::Model<double>> const& model, storm::logic::Formula const& formula, double timeLimit)
+        : model(model), matrix(model->getTransitionMatrix()), start(std::chrono::steady_clock::now()),
+          deadline(start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(timeLimit))) {
+        STORM_LOG_THROW(model->isOfType(storm::models::ModelType::Dtmc) || model->isOfType(storm::models::ModelType::Mdp), storm::exceptions::NotSupportedException,
+                        "Critical subsystems are only supported for DTMCs and MDPs.");
+        STORM_LOG_THROW(model->getInitialStates().getNumberOfSetBits() == 1, storm::exceptions::NotSupportedException, "Critical subsystems require a unique initial state.");
+        initialState = *model->getInitialStates().begin();
+
+        STORM_LOG_THROW(formula.isProbabilityOperatorFormula() && formula.asProbabilityOperatorFormula().hasBound(), storm::exceptions::InvalidArgumentException,
+                        "Expected a probability operator formula with a bound.");
+        auto const& probabilityFormula = formula.asProbabilityOperatorFormula();
+        auto comparison = probabilityFormula.getComparisonType();
+        STORM_LOG_THROW(comparison == storm::logic::ComparisonType::Less || comparison == storm::logic::ComparisonType::LessEqual, storm::exceptions::NotSupportedException,
+                        "Critical subsystems are only supported for upper bounds.");
+        strict = comparison == storm::logic::ComparisonType::LessEqual;
+        threshold = probabilityFormula.getThresholdAs<double>();
+        auto const& pathFormula = probabilityFormula.getSubformula();
+        storm::storage::BitVector phiStates(model->getNumberOfStates(), true);
+        if (pathFormula.isUntilFormula()) {
+            phiStates = checkStateFormula(pathFormula.asUntilFormula().getLeftSubformula());
+            targetStates = checkStateFormula(pathFormula.asUntilFormula().getRightSubformula());
+        } else {
+            STORM_LOG_THROW(pathFormula.isEventuallyFormula(), storm::exceptions::NotSupportedException, "Critical subsystems are only supported for (unbounded) reachability.");
+            targetStates = checkStateFormula(pathFormula.asEventuallyFormula().getSubformula());
+        }
+        // Only states satisfying phi can be left
+        expandableStates = phiStates & ~targetStates;
+        computeRows(probabilityFormula);
+        computeScores();
+    }
+
+    CriticalSubsystemResult compute(std::vector<std::string> const& heuristics, uint64_t threads) {
+        for (auto const& heuristic : heuristics) {
+            STORM_LOG_THROW(heuristic == "greedy" || heuristic == "local_search", storm::exceptions::InvalidArgumentException, "Unknown heuristic '" << heuristic << "'.");
+        }
+        best.states = storm::storage::BitVector(model->getNumberOfStates());
+        std::exception_ptr error;
+        std::mutex errorMutex;
+        auto run = [&](std::string const& heuristic) {
+            try {
+                storm::storage::BitVector subsystem = heuristic == "greedy" ? greedy() : localSearch();
+                prune(subsystem, heuristic);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                error = std::current_exception();
+            }
+        };
+        threads = threads == 0 ? heuristics.size() : threads;
+        if (threads <= 1) {
+            for (auto const& heuristic : heuristics) {
+                run(heuristic);
+            }
+        } else {
+            std::vector<std::thread> workers;
+            for (uint64_t i = 0; i < std::min<uint64_t>(threads, heuristics.size()); ++i) {
+                workers.emplace_back([&, i]() {
+                    for (uint64_t j = i; j < heuristics.size(); j += threads) {
+                        run(heuristics[j]);
+                    }
+                });
+            }
+            for (auto& worker : workers) {
+                worker.join();
+            }
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+
+        // Probability of the best subsystem until convergence (or the time limit)
+        std::vector<double> values(best.states.size(), 0.0);
+        double probability = computeProbability(best.states, values, true, best.converged);
+        best.probability = std::max(best.probability, probability);
+        return best;
+    }
+
+private:
+    std::shared_ptr<storm::models::sparse::Model<double>> model;
+    storm::storage::SparseMatrix<double> const& matrix;
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::time_point deadline;
+    uint64_t initialState;
+    double threshold;
+    bool strict;
+    storm::storage::BitVector targetStates;
+    storm::storage::BitVector expandableStates;
+    // Row of the matrix used for each state (the choice of the scheduler for MDPs)
+    std::vector<uint64_t> rows;
+    // Probability of the most probable path from the initial state to each state and from each state to the target
+    std::vector<double> forwardScores;
+    std::vector<double> backwardScores;
+    std::vector<uint64_t> forwardPredecessors;
+
+    std::mutex mutex;
+    CriticalSubsystemResult best;
+
+    static constexpr uint64_t none = std::numeric_limits<uint64_t>::max();
+
+    storm::storage::BitVector checkStateFormula(storm::logic::Formula const& formula) const {
+        storm::modelchecker::SparsePropositionalModelChecker<storm::models::sparse::Model<double>> checker(*model);
+        STORM_LOG_THROW(checker.canHandle(formula), storm::exceptions::NotSupportedException, "Cannot evaluate subformula '" << formula << "'.");
+        auto result = checker.check(storm::Environment(), storm::modelchecker::CheckTask<storm::logic::Formula, double>(formula));
+        return result->asExplicitQualitativeCheckResult().getTruthValuesVector();
+    }
+
+    void computeRows(storm::logic::ProbabilityOperatorFormula const& formula) {
+        auto const& groups = matrix.getRowGroupIndices();
+        rows.assign(groups.begin(), groups.end() - 1);
+        if (!model->isOfType(storm::models::ModelType::Mdp)) {
+            return;
+        }
+        auto maxFormula = std::make_shared<storm::logic::ProbabilityOperatorFormula>(formula.getSubformula().asSharedPointer(),
+                                                                                      storm::logic::OperatorInformation(storm::solver::OptimizationDirection::Maximize));
+        storm::modelchecker::CheckTask<storm::logic::Formula, double> task(*maxFormula, false);
+        task.setProduceSchedulers(true);
+        storm::modelchecker::SparseMdpPrctlModelChecker<storm::models::sparse::Mdp<double>> checker(*model->as<storm::models::sparse::Mdp<double>>());
+        auto result = checker.check(storm::Environment(), task);
+        auto const& scheduler = result->asExplicitQuantitativeCheckResult<double>().getScheduler();
+        for (uint64_t state = 0; state < rows.size(); ++state) {
+            auto const& choice = scheduler.getChoice(state);
+            if (choice.isDefined()) {
+                rows[state] += choice.getDeterministicChoice();
+            }
+        }
+    }
+
+    bool timeout() const {
+        return std::chrono::steady_clock::now() >= deadline;
+    }
+
+    bool exceedsThreshold(double probability) const {
+        return strict ? probability > threshold : probability >= threshold;
+    }
+
+    // Dijkstra on the (max,*) semiring in forward or backward direction
+    void computeScores() {
+        uint64_t stateCount = model->getNumberOfStates();
+        std::vector<std::vector<std::pair<uint64_t, double>>> predecessors(stateCount);
+        for (uint64_t state : expandableStates) {
+            for (auto const& entry : matrix.getRow(rows[state])) {
+                if (entry.getValue() > 0) {
+                    predecessors[entry.getColumn()].emplace_back(state, entry.getValue());
+                }
+            }
+        }
+        auto dijkstra = [&](storm::storage::BitVector const& sources, bool forward, std::vector<uint64_t>& pred) {
+            std::vector<double> distances(stateCount, 0.0);
+            pred.assign(stateCount, none);
+            std::priority_queue<std::pair<double, uint64_t>> queue;
+            for (uint64_t state : sources) {
+                distances[state] = 1.0;
+                queue.emplace(1.0, state);
+            }
+            while (!queue.empty()) {
+                double distance = queue.top().first;
+                uint64_t state = queue.top().second;
+                queue.pop();
+                if (distance < distances[state]) {
+                    continue;
+                }
+                auto relax = [&](uint64_t next, double probability) {
+                    if (distance * probability > distances[next]) {
+                        distances[next] = distance * probability;
+                        pred[next] = state;
+                        queue.emplace(distances[next], next);
+                    }
+                };
+                if (forward && expandableStates.get(state)) {
+                    for (auto const& entry : matrix.getRow(rows[state])) {
+                        if (entry.getValue() > 0) {
+                            relax(entry.getColumn(), entry.getValue());
+                        }
+                    }
+                } else if (!forward) {
+                    for (auto const& predecessor : predecessors[state]) {
+                        relax(predecessor.first, predecessor.second);
+                    }
+                }
+            }
+            return distances;
+        };
+        storm::storage::BitVector initialStates(stateCount);
+        initialStates.set(initialState);
+        forwardScores = dijkstra(initialStates, true, forwardPredecessors);
+        std::vector<uint64_t> backwardPredecessors;
+        backwardScores = dijkstra(targetStates, false, backwardPredecessors);
+    }
+
+    /*!
+     * Probability to reach the target from the initial state within the subsystem, computed by Gauss-Seidel value iteration.
+     * Values is used as starting point and must be a lower bound (e.g., the values for a smaller subsystem).
+     * The iteration stops when the time limit is reached and, unless converge is set, as soon as the threshold is exceeded.
+     * The result is a lower bound on the probability; converged is set if the iteration converged.
+     */
+    double computeProbability(storm::storage::BitVector const& subsystem, std::vector<double>& values, bool converge, bool& converged) const {
+        converged = true;
+        if (!subsystem.get(initialState)) {
+            return 0;
+        }
+        storm::storage::BitVector maybeStates = subsystem & expandableStates;
+        for (uint64_t state : subsystem & targetStates) {
+            values[state] = 1.0;
+        }
+        double difference = 1.0;
+        while (difference > 1e-12 && !timeout() && (converge || !exceedsThreshold(values[initialState]))) {
+            difference = 0;
+            for (uint64_t state : maybeStates) {
+                double value = 0;
+                for (auto const& entry : matrix.getRow(rows[state])) {
+                    if (subsystem.get(entry.getColumn())) {
+                        value += entry.getValue() * values[entry.getColumn()];
+                    }
+                }
+                difference = std::max(difference, value - values[state]);
+                values[state] = value;
+            }
+        }
+        converged = difference <= 1e-12;
+        return values[initialState];
+    }
+
+    double computeProbability(storm::storage::BitVector const& subsystem, std::vector<double>& values) const {
+        bool converged;
+        return computeProbability(subsystem, values, false, converged);
+    }
+
+    double computeProbability(storm::storage::BitVector const& subsystem) const {
+        std::vector<double> values(subsystem.size(), 0.0);
+        return computeProbability(subsystem, values);
+    }
+
+    FlatSet getLabelSet(storm::storage::BitVector const& subsystem) const {
+        FlatSet labels;
+        if (!model->hasChoiceOrigins()) {
+            return labels;
+        }
+        auto const& origins = *model->getChoiceOrigins();
+        for (uint64_t state : subsystem & expandableStates) {
+            if (origins.isPrismChoiceOrigins()) {
+                auto const& commands = origins.asPrismChoiceOrigins().getCommandSet(rows[state]);
+                labels.insert(commands.begin(), commands.end());
+            } else if (origins.isJaniChoiceOrigins()) {
+                auto const& edges = origins.asJaniChoiceOrigins().getEdgeIndexSet(rows[state]);
+                labels.insert(edges.begin(), edges.end());
+            }
+        }
+        return labels;
+    }
+
+    // Replaces the best result if the subsystem is better. The probability is a lower bound from the search.
+    void report(storm::storage::BitVector const& subsystem, double probability, std::string const& heuristic) {
+        CriticalSubsystemResult result;
+        result.states = subsystem;
+        result.probability = probability;
+        result.critical = exceedsThreshold(result.probability);
+        result.labelSet = getLabelSet(subsystem);
+        result.heuristic = heuristic;
+        result.time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        bool better;
+        if (result.critical != best.critical) {
+            better = result.critical;
+        } else if (!result.critical) {
+            better = result.probability > best.probability;
+        } else if (result.labelSet.size() != best.labelSet.size()) {
+            better = result.labelSet.size() < best.labelSet.size();
+        } else {
+            better = result.states.getNumberOfSetBits() < best.states.getNumberOfSetBits();
+        }
+        if (better) {
+            best = std::move(result);
+        }
+    }
+
+    // States which can contribute to the probability, in descending order of the most probable path through them
+    std::vector<uint64_t> getRelevantStatesByScore() const {
+        std::vector<uint64_t> states;
+        for (uint64_t state = 0; state < forwardScores.size(); ++state) {
+            if (forwardScores[state] * backwardScores[state] > 0) {
+                states.push_back(state);
+            }
+        }
+        std::stable_sort(states.begin(), states.end(),
+                         [this](uint64_t a, uint64_t b) { return forwardScores[a] * backwardScores[a] > forwardScores[b] * backwardScores[b]; });
+        return states;
+    }
+
+    storm::storage::BitVector greedy() {
+        std::vector<uint64_t> states = getRelevantStatesByScore();
+        auto prefix = [&](uint64_t length) {
+            storm::storage::BitVector subsystem(model->getNumberOfStates());
+            for (uint64_t i = 0; i < length; ++i) {
+                subsystem.set(states[i]);
+            }
+            return subsystem;
+        };
+        // Exponential search for a sufficient prefix, followed by binary search
+        uint64_t lower = 0;
+        uint64_t upper = 1;
+        while (upper < states.size() && !exceedsThreshold(computeProbability(prefix(upper))) && !timeout()) {
+            lower = upper;
+            upper *= 2;
+        }
+        upper = std::min<uint64_t>(upper, states.size());
+        while (upper - lower > 1 && !timeout()) {
+            uint64_t middle = lower + (upper - lower) / 2;
+            if (exceedsThreshold(computeProbability(prefix(middle)))) {
+                upper = middle;
+            } else {
+                lower = middle;
+            }
+        }
+        storm::storage::BitVector subsystem = prefix(upper);
+        report(subsystem, computeProbability(subsystem), "greedy");
+        return subsystem;
+    }
+
+    storm::storage::BitVector localSearch() {
+        uint64_t stateCount = model->getNumberOfStates();
+        storm::storage::BitVector subsystem(stateCount);
+        // Most probable path
+        uint64_t bestTarget = none;
+        for (uint64_t target : targetStates) {
+            if (forwardScores[target] > 0 && (bestTarget == none || forwardScores[target] > forwardScores[bestTarget])) {
+                bestTarget = target;
+            }
+        }
+        for (uint64_t state = bestTarget; state != none; state = forwardPredecessors[state]) {
+            subsystem.set(state);
+        }
+        std::vector<double> values(stateCount, 0.0);
+        std::vector<double> distances(stateCount);
+        std::vector<uint64_t> predecessors(stateCount);
+        double probability = 0;
+        while (!timeout()) {
+            probability = computeProbability(subsystem, values);
+            if (exceedsThreshold(probability)) {
+                break;
+            }
+            // Most probable fragment from the subsystem over states outside the subsystem back to the subsystem or to a target
+            std::fill(distances.begin(), distances.end(), 0.0);
+            std::priority_queue<std::pair<double, uint64_t>> queue;
+            double bestFragment = 0;
+            uint64_t fragmentEnd = none;
+            auto relax = [&](uint64_t state, uint64_t next, double distance) {
+                if (subsystem.get(next)) {
+                    if (!subsystem.get(state) && distance > bestFragment) {
+                        bestFragment = distance;
+                        fragmentEnd = state;
+                    }
+                } else if (backwardScores[next] > 0 && distance > distances[next]) {
+                    distances[next] = distance;
+                    predecessors[next] = state;
+                    queue.emplace(distance, next);
+                }
+            };
+            for (uint64_t state : subsystem & expandableStates) {
+                for (auto const& entry : matrix.getRow(rows[state])) {
+                    if (entry.getValue() > 0) {
+                        relax(state, entry.getColumn(), entry.getValue());
+                    }
+                }
+            }
+            while (!queue.empty()) {
+                double distance = queue.top().first;
+                uint64_t state = queue.top().second;
+                queue.pop();
+                if (distance < distances[state] || distance <= bestFragment) {
+                    continue;
+                }
+                if (targetStates.get(state)) {
+                    bestFragment = distance;
+                    fragmentEnd = state;
+                    continue;
+                }
+                if (expandableStates.get(state)) {
+                    for (auto const& entry : matrix.getRow(rows[state])) {
+                        if (entry.getValue() > 0) {
+                            relax(state, entry.getColumn(), distance * entry.getValue());
+                        }
+                    }
+                }
+            }
+            if (fragmentEnd == none) {
+                break;
+            }
+            for (uint64_t state = fragmentEnd; !subsystem.get(state); state = predecessors[state]) {
+                subsystem.set(state);
+            }
+        }
+        report(subsystem, probability, "local_search");
+        return subsystem;
+    }
+
+    // Remove states with low score as long as the subsystem stays critical
+    void prune(storm::storage::BitVector subsystem, std::string const& heuristic) {
+        if (!exceedsThreshold(computeProbability(subsystem))) {
+            return;
+        }
+        std::vector<uint64_t> states = getRelevantStatesByScore();
+        for (auto it = states.rbegin(); it != states.rend() && !timeout(); ++it) {
+            if (*it == initialState || !subsystem.get(*it)) {
+                continue;
+            }
+            subsystem.set(*it, false);
+            double probability = computeProbability(subsystem);
+            if (!timeout() && exceedsThreshold(probability)) {
+                report(subsystem, probability, heuristic);
+            } else {
+                subsystem.set(*it, true);
+            }
+        }
+    }
+};
+
 // Define python bindings
 void define_counterexamples(py::module& m) {
 
-    using FlatSet = boost::container::flat_set<uint64_t, std::less<uint64_t>, boost::container::new_allocator<uint64_t>>;
-
     py::class_<FlatSet>(m, "FlatSet", "Container to pass to program")
             .def(py::init<>())
             .def(py::init<FlatSet>(), "other"_a)
@@ -58,6 +530,31 @@ void define_counterexamples(py::module& m) {
         py::class_<CexInput>(m, "SMTCounterExampleInput", "Precomputed input for counterexample generation")
                 .def("add_reward_and_threshold", &CexInput::addRewardThresholdCombination, "add another reward structure and threshold", py::arg("reward_name"), py::arg("threshold"));
 
+    py::class_<CriticalSubsystemResult>(m, "CriticalSubsystemResult", "Result of the heuristic computation of a critical subsystem")
+        .def_readonly("states", &CriticalSubsystemResult::states, "States of the subsystem")
+        .def_readonly("label_set", &CriticalSubsystemResult::labelSet, "Commands (Prism) or edges (Jani) used by the subsystem, empty if the model has no choice origins")
+        .def_readonly("probability", &CriticalSubsystemResult::probability, "Probability of the subsystem (computed by value iteration, a lower bound unless converged is set)")
+        .def_readonly("converged", &CriticalSubsystemResult::converged, "Whether value iteration for the probability converged before the time limit")
+        .def_readonly("critical", &CriticalSubsystemResult::critical, "Whether the probability exceeds the bound, i.e., the subsystem is a counterexample")
+        .def_readonly("heuristic", &CriticalSubsystemResult::heuristic, "Heuristic which found the subsystem")
+        .def_readonly("time", &CriticalSubsystemResult::time, "Time (in seconds) after which the subsystem was found")
+        .def_property_readonly("nr_states", [](CriticalSubsystemResult const& result) { return result.states.getNumberOfSetBits(); }, "Number of states of the subsystem")
+    ;
+
+    m.def("compute_critical_subsystem", [](std::shared_ptr<storm::models::sparse::Model<double>> const& model, storm::logic::Formula const& formula, double timeLimit,
+                                           std::vector<std::string> const& heuristics, uint64_t threads) {
+            return CriticalSubsystemSearch(model, formula, timeLimit).compute(heuristics, threads);
+        }, py::arg("model"), py::arg("formula"), py::arg("time_limit") = 10.0, py::arg("heuristics") = std::vector<std::string>({"greedy", "local_search"}),
+        py::arg("threads") = 0, py::call_guard<py::gil_scoped_release>(), R"dox(
 
+        Compute a small critical subsystem (counterexample) for an upper probability bound with a portfolio of heuristics.
+        In contrast to the SMT-based generator, the result is not necessarily minimal.
 
+        :param model: DTMC or MDP with a unique initial state
+        :param Formula formula: Formula of the form P<=p [phi U psi] or P<p [F psi]
+        :param double time_limit: Time limit (in seconds), after which the best subsystem found so far is returned
+        :param List[str] heuristics: Heuristics to use, from 'greedy' and 'local_search'
+        :param int threads: Number of threads. If 0, each heuristic runs in its own thread.
+        :return: Best subsystem found
+        )dox");
 }
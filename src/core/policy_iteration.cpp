@@ -0,0 +1,309 @@
+#include "policy_iteration.h"
+#include "src/numpy_helpers.h"
+
+#include "storm/environment/Environment.h"
+#include "storm/logic/Formulas.h"
+#include "storm/modelchecker/CheckTask.h"
+#include "storm/modelchecker/propositional/SparsePropositionalModelChecker.h"
+#include "storm/modelchecker/results/ExplicitQualitativeCheckResult.h"
+#include "storm/models/sparse/Mdp.h"
+#include "storm/models/sparse/StandardRewardModel.h"
+#include "storm/solver/OptimizationDirection.h"
+#include "storm/storage/BitVector.h"
+#include "storm/storage/Scheduler.h"
+#include "storm/utility/constants.h"
+#include "storm/utility/graph.h"
+#include "storm/utility/macros.h"
+#include "storm/utility/vector.h"
+#include "storm/exceptions/InvalidArgumentException.h"
+#include "storm/exceptions/NotSupportedException.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <optional>
+
+using Mdp = storm::models::sparse::Mdp<double>;
+using ChoiceArray = py::array_t<int64_t, py::array::c_style | py::array::forcecast>;
+
+struct PolicyIterationResult {
+    std::vector<double> values;
+    // Local choice index of the final policy for each state
+    std::vector<uint64_t> choices;
+    // Statistics for each improvement step
+    std::vector<uint64_t> changedChoices;
+    std::vector<double> improvements;
+    // Number of value iterations needed to evaluate each policy
+    std::vector<uint64_t> evaluationIterations;
+    bool converged = false;
+
+    storm::storage::Scheduler<double> getScheduler() const {
+        storm::storage::Scheduler<double> scheduler(choices.size());
+        for (uint64_t state = 0; state < choices.size(); ++state) {
+            scheduler.setChoice(storm::storage::SchedulerChoice<double>(choices[state]), state);
+        }
+        return scheduler;
+    }
+};
+
+/*!
+ * Policy iteration for reachability probabilities and expected rewards until reaching a target in MDPs.
+ * Policies are evaluated by Gauss-Seidel value iteration which starts from the values of the previous policy, hence a good
+ * initial policy only needs a few (cheap) evaluations.
+ * States with value 0 or 1 (probabilities) or infinite value (rewards) are determined by graph analysis beforehand.
+ */
+class PolicyIteration {
+public:
+    PolicyIteration(Mdp const& mdp, storm::logic::Formula const& formula)
+        : mdp(mdp), matrix(mdp.getTransitionMatrix()), groups(mdp.getNondeterministicChoiceIndices()), phiStates(mdp.getNumberOfStates(), true) {
+        STORM_LOG_THROW(formula.isProbabilityOperatorFormula() || formula.isRewardOperatorFormula(), storm::exceptions::NotSupportedException,
+                        "Policy iteration is only supported for probability and reward operators.");
+        auto const& operatorFormula = formula.asOperatorFormula();
+        STORM_LOG_THROW(operatorFormula.hasOptimalityType(), storm::exceptions::InvalidArgumentException, "Formula must specify whether to minimize or maximize.");
+        direction = operatorFormula.getOptimalityType();
+        auto const& pathFormula = operatorFormula.getSubformula();
+        if (pathFormula.isUntilFormula() && formula.isProbabilityOperatorFormula()) {
+            phiStates = checkStateFormula(pathFormula.asUntilFormula().getLeftSubformula());
+            psiStates = checkStateFormula(pathFormula.asUntilFormula().getRightSubformula());
+        } else {
+            STORM_LOG_THROW(pathFormula.isEventuallyFormula(), storm::exceptions::NotSupportedException, "Policy iteration is only supported for (unbounded) reachability.");
+            psiStates = checkStateFormula(pathFormula.asEventuallyFormula().getSubformula());
+        }
+        if (formula.isRewardOperatorFormula()) {
+            auto const& rewardFormula = formula.asRewardOperatorFormula();
+            auto const& rewardModel = rewardFormula.hasRewardModelName() ? mdp.getRewardModel(rewardFormula.getRewardModelName()) : mdp.getUniqueRewardModel();
+            choiceRewards = rewardModel.getTotalRewardVector(matrix);
+        }
+    }
+
+    PolicyIterationResult solve(std::optional<std::vector<int64_t>> const& initialChoices, double precision, uint64_t maxIterations, uint64_t maxEvaluationIterations) {
+        initialize();
+        std::vector<uint64_t> rows = getInitialRows(initialChoices);
+
+        PolicyIterationResult result;
+        result.evaluationIterations.push_back(evaluate(rows, precision, maxEvaluationIterations));
+        for (uint64_t iteration = 0; iteration < maxIterations; ++iteration) {
+            uint64_t changed = improve(rows, precision);
+            if (changed == 0) {
+                result.converged = true;
+                break;
+            }
+            std::vector<double> previousValues = values;
+            result.evaluationIterations.push_back(evaluate(rows, precision, maxEvaluationIterations));
+            result.changedChoices.push_back(changed);
+            double improvement = 0;
+            for (uint64_t state : maybeStates) {
+                improvement = std::max(improvement, std::abs(values[state] - previousValues[state]));
+            }
+            result.improvements.push_back(improvement);
+        }
+
+        result.choices.resize(rows.size());
+        for (uint64_t state = 0; state < rows.size(); ++state) {
+            result.choices[state] = rows[state] - groups[state];
+        }
+        result.values = std::move(values);
+        return result;
+    }
+
+private:
+    Mdp const& mdp;
+    storm::storage::SparseMatrix<double> const& matrix;
+    std::vector<uint64_t> const& groups;
+    storm::solver::OptimizationDirection direction;
+    storm::storage::BitVector phiStates;
+    storm::storage::BitVector psiStates;
+    // Only set for expected rewards
+    std::optional<std::vector<double>> choiceRewards;
+
+    std::vector<double> values;
+    storm::storage::BitVector maybeStates;
+    storm::storage::BitVector allowedChoices;
+
+    bool minimize() const {
+        return direction == storm::solver::OptimizationDirection::Minimize;
+    }
+
+    storm::storage::BitVector checkStateFormula(storm::logic::Formula const& formula) const {
+        storm::modelchecker::SparsePropositionalModelChecker<Mdp> checker(mdp);
+        STORM_LOG_THROW(checker.canHandle(formula), storm::exceptions::NotSupportedException, "Cannot evaluate subformula '" << formula << "'.");
+        auto result = checker.check(storm::Environment(), storm::modelchecker::CheckTask<storm::logic::Formula, double>(formula));
+        return result->asExplicitQualitativeCheckResult().getTruthValuesVector();
+    }
+
+    void initialize() {
+        values.assign(mdp.getNumberOfStates(), storm::utility::zero<double>());
+        allowedChoices = storm::storage::BitVector(matrix.getRowCount(), true);
+        if (!choiceRewards) {
+            auto prob01 = minimize() ? storm::utility::graph::performProb01Min(mdp, phiStates, psiStates) : storm::utility::graph::performProb01Max(mdp, phiStates, psiStates);
+            storm::utility::vector::setVectorValues(values, prob01.second, storm::utility::one<double>());
+            maybeStates = ~(prob01.first | prob01.second);
+            return;
+        }
+        auto backwardTransitions = mdp.getBackwardTransitions();
+        storm::storage::BitVector prob1States = minimize() ? storm::utility::graph::performProb1E(matrix, groups, backwardTransitions, phiStates, psiStates)
+                                                           : storm::utility::graph::performProb1A(matrix, groups, backwardTransitions, phiStates, psiStates);
+        storm::utility::vector::setVectorValues(values, ~prob1States, storm::utility::infinity<double>());
+        maybeStates = prob1States & ~psiStates;
+        if (minimize()) {
+            // Choices that might leave the states with finite reward are never optimal
+            for (uint64_t row = 0; row < matrix.getRowCount(); ++row) {
+                for (auto const& entry : matrix.getRow(row)) {
+                    if (!prob1States.get(entry.getColumn()) && !storm::utility::isZero(entry.getValue())) {
+                        allowedChoices.set(row, false);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    std::vector<uint64_t> getInitialRows(std::optional<std::vector<int64_t>> const& initialChoices) const {
+        std::vector<uint64_t> rows(groups.begin(), groups.end() - 1);
+        if (initialChoices) {
+            STORM_LOG_THROW(initialChoices->size() == rows.size(), storm::exceptions::InvalidArgumentException,
+                            "Expected " << rows.size() << " initial choices but got " << initialChoices->size() << ".");
+        }
+        for (uint64_t state : maybeStates) {
+            if (initialChoices && (*initialChoices)[state] >= 0) {
+                rows[state] = groups[state] + (*initialChoices)[state];
+                STORM_LOG_THROW(rows[state] < groups[state + 1], storm::exceptions::InvalidArgumentException, "Choice " << (*initialChoices)[state] << " is not available in state " << state << ".");
+                STORM_LOG_THROW(allowedChoices.get(rows[state]), storm::exceptions::InvalidArgumentException, "Initial choice of state " << state << " yields infinite reward.");
+            } else {
+                rows[state] = allowedChoices.getNextSetIndex(groups[state]);
+            }
+        }
+        if (choiceRewards && minimize()) {
+            makeProper(rows, initialChoices.has_value());
+        }
+        return rows;
+    }
+
+    /*!
+     * For minimal rewards, a policy which does not reach the target almost surely might have zero reward.
+     * Such choices are replaced by choices that move towards the target (or rejected if they were given explicitly).
+     * Policy improvement preserves that the target is reached almost surely.
+     */
+    void makeProper(std::vector<uint64_t>& rows, bool userChoices) const {
+        storm::storage::BitVector attracted = psiStates;
+        // States reaching the target under the current policy
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (uint64_t state : maybeStates & ~attracted) {
+                for (auto const& entry : matrix.getRow(rows[state])) {
+                    if (attracted.get(entry.getColumn()) && !storm::utility::isZero(entry.getValue())) {
+                        attracted.set(state);
+                        changed = true;
+                        break;
+                    }
+                }
+            }
+        }
+        STORM_LOG_THROW(!userChoices || maybeStates.isSubsetOf(attracted), storm::exceptions::InvalidArgumentException,
+                        "Initial policy does not reach the target almost surely, which is required for minimal expected rewards.");
+        // Attractor construction for the remaining states
+        changed = true;
+        while (changed) {
+            changed = false;
+            for (uint64_t state : maybeStates & ~attracted) {
+                for (uint64_t row = groups[state]; row < groups[state + 1] && !attracted.get(state); ++row) {
+                    if (!allowedChoices.get(row)) {
+                        continue;
+                    }
+                    for (auto const& entry : matrix.getRow(row)) {
+                        if (attracted.get(entry.getColumn()) && !storm::utility::isZero(entry.getValue())) {
+                            rows[state] = row;
+                            attracted.set(state);
+                            changed = true;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    double getChoiceValue(uint64_t row) const {
+        double value = matrix.multiplyRowWithVector(row, values);
+        return choiceRewards ? value + (*choiceRewards)[row] : value;
+    }
+
+    // Gauss-Seidel value iteration for the given policy, starting from the current values. Returns the number of iterations.
+    uint64_t evaluate(std::vector<uint64_t> const& rows, double precision, uint64_t maxIterations) {
+        for (uint64_t iteration = 1; iteration <= maxIterations; ++iteration) {
+            double difference = 0;
+            for (uint64_t state : maybeStates) {
+                double value = getChoiceValue(rows[state]);
+                difference = std::max(difference, std::abs(value - values[state]));
+                values[state] = value;
+            }
+            if (difference <= precision) {
+                return iteration;
+            }
+        }
+        STORM_LOG_WARN("Policy evaluation did not converge within " << maxIterations << " iterations.");
+        return maxIterations;
+    }
+
+    // Switch to choices which are better by more than the precision. Returns the number of switched choices.
+    uint64_t improve(std::vector<uint64_t>& rows, double precision) const {
+        uint64_t changed = 0;
+        for (uint64_t state : maybeStates) {
+            double bestValue = getChoiceValue(rows[state]);
+            uint64_t bestRow = rows[state];
+            for (uint64_t row = groups[state]; row < groups[state + 1]; ++row) {
+                if (!allowedChoices.get(row)) {
+                    continue;
+                }
+                double value = getChoiceValue(row);
+                if (minimize() ? value < bestValue - precision : value > bestValue + precision) {
+                    bestValue = value;
+                    bestRow = row;
+                }
+            }
+            if (bestRow != rows[state]) {
+                rows[state] = bestRow;
+                ++changed;
+            }
+        }
+        return changed;
+    }
+};
+
+void define_policy_iteration(py::module& m) {
+    py::class_<PolicyIterationResult>(m, "PolicyIterationResult", "Result of policy iteration")
+        .def_property_readonly("values", [](py::object const& self) { return vectorAsNumpy(self.cast<PolicyIterationResult const&>().values, self); }, "Value of each state")
+        .def_property_readonly("choices", [](py::object const& self) { return vectorAsNumpy(self.cast<PolicyIterationResult const&>().choices, self); }, "Local choice index of the computed policy for each state")
+        .def_property_readonly("scheduler", &PolicyIterationResult::getScheduler, "Computed policy as scheduler")
+        .def_readonly("changed_choices", &PolicyIterationResult::changedChoices, "Number of states whose choice changed in each improvement step")
+        .def_readonly("improvements", &PolicyIterationResult::improvements, "Maximal change of a value in each improvement step")
+        .def_readonly("evaluation_iterations", &PolicyIterationResult::evaluationIterations, "Number of value iterations for evaluating each policy")
+        .def_readonly("converged", &PolicyIterationResult::converged, "Whether the policy is stable, i.e., no improvement was possible")
+        .def_property_readonly("nr_iterations", [](PolicyIterationResult const& result) { return result.evaluationIterations.size(); }, "Number of evaluated policies")
+    ;
+
+    m.def("check_mdp_policy_iteration", [](Mdp const& mdp, storm::logic::Formula const& formula, std::optional<ChoiceArray> const& initialChoices, double precision,
+                                           uint64_t maxIterations, uint64_t maxEvaluationIterations) {
+            std::optional<std::vector<int64_t>> choices;
+            if (initialChoices) {
+                STORM_LOG_THROW(initialChoices->ndim() == 1, storm::exceptions::InvalidArgumentException, "Expected one-dimensional array.");
+                choices = std::vector<int64_t>(initialChoices->data(), initialChoices->data() + initialChoices->size());
+            }
+            py::gil_scoped_release release;
+            return PolicyIteration(mdp, formula).solve(choices, precision, maxIterations, maxEvaluationIterations);
+        }, py::arg("model"), py::arg("formula"), py::arg("initial_choices") = std::nullopt, py::arg("precision") = 1e-6, py::arg("maximal_iterations") = 1000,
+        py::arg("maximal_evaluation_iterations") = std::numeric_limits<uint64_t>::max(), R"dox(
+
+        Compute optimal reachability probabilities or expected rewards in an MDP by policy iteration.
+        The iteration can be warm-started from a policy given as array, e.g., the result of a previous run on a similar model.
+
+        :param SparseMdp model: MDP
+        :param Formula formula: Probability (P) or reward (R) operator formula with minimization or maximization over an (until or) eventually formula
+        :param initial_choices: Array containing the initial (local) choice index for each state, -1 for no preference
+        :param double precision: Precision for the policy evaluation and the improvement of choices
+        :param int maximal_iterations: Maximal number of policy improvements
+        :param int maximal_evaluation_iterations: Maximal number of value iterations for evaluating a policy
+        :return: Result containing the values, the policy and statistics for each iteration
+        )dox");
+}
@@ -0,0 +1,5 @@
+#pragma once
+
+#include "common.h"
+
+void define_policy_iteration(py::module& m);
@@ -3,6 +3,23 @@
 #include "storm-dft/parser/DFTJsonParser.h"
 #include "storm-dft/builder/ExplicitDFTModelBuilder.h"
 #include "storm-dft/storage/DftSymmetries.h"
+#include "storm-dft/generator/DftNextStateGenerator.h"
+#include "storm-dft/storage/DFTState.h"
+
+#include <storm/models/sparse/Ctmc.h>
+#include <storm/models/sparse/MarkovAutomaton.h>
+#include <storm/storage/sparse/ModelComponents.h>
+#include <storm/exceptions/InvalidOperationException.h>
+#include <storm/utility/macros.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
 
 template<typename ValueType> using ExplicitDFTModelBuilder = storm::dft::builder::ExplicitDFTModelBuilder<ValueType>;
 
@@ -27,6 +44,272 @@ std::shared_ptr<storm::models::sparse::Model<ValueType>> buildModel(storm::dft::
     return builder.getModel();
 }
 
+struct ParallelDFTBuildStatistics {
+    uint64_t states = 0;
+    uint64_t transitions = 0;
+    uint64_t levels = 0;
+    uint64_t threads = 0;
+    double explorationTime = 0;
+    double constructionTime = 0;
+
+    double getStatesPerSecond() const {
+        return explorationTime > 0 ? states / explorationTime : 0;
+    }
+
+    std::string toString() const {
+        std::stringstream stream;
+        stream << "Explored " << states << " states with " << transitions << " transitions in " << levels << " levels with " << threads << " threads in " << explorationTime
+               << "s (" << getStatesPerSecond() << " states/s), model construction took " << constructionTime << "s";
+        return stream.str();
+    }
+};
+
+/*!
+ * Multithreaded state space generation for DFTs.
+ * The state space is explored level by level, each worker thread uses its own next-state generator.
+ * States are identified by their bit-packed DFT status and stored in a hash table which is split into shards with separate locks.
+ * As in the ExplicitDFTModelBuilder, all failed states are merged into a unique failed state with id 0.
+ * State ids depend on the interleaving of the workers unless a single thread is used.
+ */
+template<typename ValueType>
+class ParallelDFTModelBuilder {
+public:
+    ParallelDFTModelBuilder(storm::dft::storage::DFT<ValueType> const& dft, storm::dft::storage::DftSymmetries const& symmetries, uint64_t threads)
+        : dft(dft), stateGenerationInfo(dft.buildStateGenerationInfo(symmetries)) {
+        this->threads = threads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : threads;
+    }
+
+    void buildModel() {
+        auto start = std::chrono::steady_clock::now();
+        statistics = ParallelDFTBuildStatistics();
+        statistics.threads = threads;
+        for (auto& shard : shards) {
+            shard.ids.clear();
+        }
+        statuses.clear();
+        behaviors.clear();
+
+        // Unique failed state with id 0. Creating it makes a generator redirect all failed successors to it, thus every generator has to create it.
+        statuses.emplace_back();
+        counter = 1;
+        std::vector<std::unique_ptr<Generator>> generators;
+        for (uint64_t worker = 0; worker < threads; ++worker) {
+            generators.push_back(std::make_unique<Generator>(dft, stateGenerationInfo));
+            auto failedBehavior = generators.back()->createMergeFailedState([](DFTStatePointer const&) { return 0; });
+            if (worker == 0) {
+                behaviors.push_back(toRows(failedBehavior));
+            }
+        }
+
+        std::vector<std::vector<std::pair<uint64_t, storm::storage::BitVector>>> discovered(threads);
+        initialStates.clear();
+        for (auto const& id : generators[0]->getInitialStates([this, &discovered](DFTStatePointer const& state) { return getOrAddState(state, discovered[0]); })) {
+            initialStates.push_back(id);
+        }
+        std::vector<uint64_t> frontier = collect(discovered);
+        while (!frontier.empty()) {
+            behaviors.resize(counter);
+            std::atomic<uint64_t> next(0);
+            std::vector<std::exception_ptr> exceptions(threads);
+            auto work = [&](uint64_t worker) {
+                try {
+                    Generator& generator = *generators[worker];
+                    auto callback = [this, &discovered, worker](DFTStatePointer const& state) { return getOrAddState(state, discovered[worker]); };
+                    for (uint64_t index = next++; index < frontier.size(); index = next++) {
+                        generator.load(statuses[frontier[index]]);
+                        behaviors[frontier[index]] = toRows(generator.expand(callback));
+                    }
+                } catch (...) {
+                    exceptions[worker] = std::current_exception();
+                }
+            };
+            if (threads == 1) {
+                work(0);
+            } else {
+                std::vector<std::thread> workers;
+                for (uint64_t worker = 0; worker < threads; ++worker) {
+                    workers.emplace_back(work, worker);
+                }
+                for (auto& worker : workers) {
+                    worker.join();
+                }
+            }
+            for (auto const& exception : exceptions) {
+                if (exception) {
+                    std::rethrow_exception(exception);
+                }
+            }
+            frontier = collect(discovered);
+            ++statistics.levels;
+        }
+        statistics.states = counter;
+        statistics.explorationTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        auto constructionStart = std::chrono::steady_clock::now();
+        model = buildSparseModel();
+        statistics.transitions = model->getNumberOfTransitions();
+        statistics.constructionTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - constructionStart).count();
+    }
+
+    std::shared_ptr<storm::models::sparse::Model<ValueType>> getModel() const {
+        STORM_LOG_THROW(model, storm::exceptions::InvalidOperationException, "The model has not been built yet.");
+        return model;
+    }
+
+    ParallelDFTBuildStatistics const& getStatistics() const {
+        return statistics;
+    }
+
+private:
+    using Generator = storm::dft::generator::DftNextStateGenerator<ValueType>;
+    using DFTStatePointer = std::shared_ptr<storm::dft::storage::DFTState<ValueType>>;
+
+    // Choice of a state: whether it is Markovian and its successors (state id and rate or probability)
+    struct Row {
+        bool markovian;
+        std::vector<std::pair<uint64_t, ValueType>> successors;
+    };
+
+    template<typename Behavior>
+    static std::vector<Row> toRows(Behavior const& behavior) {
+        std::vector<Row> rows;
+        for (auto const& choice : behavior) {
+            Row row{choice.isMarkovian(), {}};
+            for (auto const& entry : choice) {
+                row.successors.emplace_back(entry.first, entry.second);
+            }
+            rows.push_back(std::move(row));
+        }
+        return rows;
+    }
+
+    uint64_t getOrAddState(DFTStatePointer const& state, std::vector<std::pair<uint64_t, storm::storage::BitVector>>& discovered) {
+        storm::storage::BitVector const& status = state->status();
+        Shard& shard = shards[std::hash<storm::storage::BitVector>()(status) % shardCount];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.ids.find(status);
+        if (it != shard.ids.end()) {
+            state->setId(it->second);
+            return it->second;
+        }
+        uint64_t id = counter++;
+        shard.ids.emplace(status, id);
+        state->setId(id);
+        discovered.emplace_back(id, status);
+        return id;
+    }
+
+    // Store the statuses of newly discovered states and return them as next frontier
+    std::vector<uint64_t> collect(std::vector<std::vector<std::pair<uint64_t, storm::storage::BitVector>>>& discovered) {
+        std::vector<uint64_t> frontier;
+        statuses.resize(counter);
+        for (auto& newStates : discovered) {
+            for (auto& [id, status] : newStates) {
+                statuses[id] = std::move(status);
+                frontier.push_back(id);
+            }
+            newStates.clear();
+        }
+        std::sort(frontier.begin(), frontier.end());
+        return frontier;
+    }
+
+    std::shared_ptr<storm::models::sparse::Model<ValueType>> buildSparseModel() const {
+        uint64_t stateCount = counter;
+        bool deterministic = std::all_of(behaviors.begin(), behaviors.end(), [](std::vector<Row> const& rows) { return rows.size() <= 1 && (rows.empty() || rows.front().markovian); });
+        storm::storage::SparseMatrixBuilder<ValueType> builder(0, stateCount, 0, false, !deterministic, deterministic ? 0 : stateCount);
+        storm::storage::BitVector markovianStates(stateCount);
+        uint64_t row = 0;
+        for (uint64_t id = 0; id < stateCount; ++id) {
+            if (!deterministic) {
+                builder.newRowGroup(row);
+            }
+            if (behaviors[id].empty()) {
+                // Absorbing state
+                builder.addNextValue(row++, id, storm::utility::one<ValueType>());
+                markovianStates.set(id);
+                continue;
+            }
+            for (auto const& choice : behaviors[id]) {
+                if (choice.markovian) {
+                    markovianStates.set(id);
+                }
+                for (auto const& [successor, value] : choice.successors) {
+                    builder.addNextValue(row, successor, value);
+                }
+                ++row;
+            }
+        }
+
+        storm::models::sparse::StateLabeling labeling(stateCount);
+        storm::storage::BitVector init(stateCount);
+        for (auto const& id : initialStates) {
+            init.set(id);
+        }
+        labeling.addLabel("init", std::move(init));
+        storm::storage::BitVector failed(stateCount);
+        storm::storage::BitVector failsafe(stateCount);
+        failed.set(0);
+        std::vector<std::pair<uint64_t, std::pair<storm::storage::BitVector, storm::storage::BitVector>>> relevantLabels;
+        for (uint64_t element = 0; element < dft.nrElements(); ++element) {
+            if (dft.getElement(element)->isRelevant()) {
+                relevantLabels.emplace_back(element, std::make_pair(storm::storage::BitVector(stateCount), storm::storage::BitVector(stateCount)));
+            }
+        }
+        for (uint64_t id = 1; id < stateCount; ++id) {
+            storm::dft::storage::DFTState<ValueType> state(statuses[id], dft, stateGenerationInfo, id);
+            failed.set(id, state.hasFailed(dft.getTopLevelIndex()));
+            failsafe.set(id, state.isFailsafe(dft.getTopLevelIndex()));
+            for (auto& [element, labelStates] : relevantLabels) {
+                labelStates.first.set(id, state.hasFailed(element));
+                labelStates.second.set(id, state.dontCare(element));
+            }
+        }
+        labeling.addLabel("failed", std::move(failed));
+        labeling.addLabel("failsafe", std::move(failsafe));
+        for (auto& [element, labelStates] : relevantLabels) {
+            labeling.addLabel(dft.getElement(element)->name() + "_failed", std::move(labelStates.first));
+            labeling.addLabel(dft.getElement(element)->name() + "_dc", std::move(labelStates.second));
+        }
+
+        storm::storage::sparse::ModelComponents<ValueType> components(builder.build(row, stateCount, deterministic ? 0 : stateCount), std::move(labeling));
+        components.rateTransitions = true;
+        if (deterministic) {
+            return std::make_shared<storm::models::sparse::Ctmc<ValueType>>(std::move(components));
+        }
+        components.markovianStates = std::move(markovianStates);
+        return std::make_shared<storm::models::sparse::MarkovAutomaton<ValueType>>(std::move(components));
+    }
+
+    static constexpr std::size_t shardCount = 64;
+
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<storm::storage::BitVector, uint64_t> ids;
+    };
+
+    storm::dft::storage::DFT<ValueType> const& dft;
+    storm::dft::storage::DFTStateGenerationInfo stateGenerationInfo;
+    uint64_t threads;
+    std::array<Shard, shardCount> shards;
+    std::atomic<uint64_t> counter{0};
+    // Bit-packed status and choices of each state
+    std::vector<storm::storage::BitVector> statuses;
+    std::vector<std::vector<Row>> behaviors;
+    std::vector<uint64_t> initialStates;
+    std::shared_ptr<storm::models::sparse::Model<ValueType>> model;
+    ParallelDFTBuildStatistics statistics;
+};
+
+// Thin wrapper for building the state space from a DFT with multiple threads
+template<typename ValueType>
+std::shared_ptr<storm::models::sparse::Model<ValueType>> buildModelParallel(storm::dft::storage::DFT<ValueType> const& dft, storm::dft::storage::DftSymmetries const& symmetries, storm::dft::utility::RelevantEvents const& relevantEvents, bool allowDCForRelevant, uint64_t threads) {
+    dft.setRelevantEvents(relevantEvents, allowDCForRelevant);
+    ParallelDFTModelBuilder<ValueType> builder(dft, symmetries, threads);
+    builder.buildModel();
+    return builder.getModel();
+}
+
 // Define python bindings
 void define_analysis(py::module& m) {
 
@@ -43,6 +326,17 @@ void define_analysis(py::module& m) {
     ;
 
     m.def("compute_relevant_events", &storm::dft::api::computeRelevantEvents, "Compute relevant event ids from properties and additional relevant names", py::arg("properties"), py::arg("additional_relevant_names") = std::vector<std::string>());
+
+    py::class_<ParallelDFTBuildStatistics>(m, "ParallelDFTBuildStatistics", "Statistics of the parallel state space generation")
+        .def_readonly("states", &ParallelDFTBuildStatistics::states, "Number of states")
+        .def_readonly("transitions", &ParallelDFTBuildStatistics::transitions, "Number of transitions")
+        .def_readonly("levels", &ParallelDFTBuildStatistics::levels, "Number of explored levels (breadth-first)")
+        .def_readonly("threads", &ParallelDFTBuildStatistics::threads, "Number of threads")
+        .def_readonly("exploration_time", &ParallelDFTBuildStatistics::explorationTime, "Time for the exploration in seconds")
+        .def_readonly("construction_time", &ParallelDFTBuildStatistics::constructionTime, "Time for the construction of the sparse model in seconds")
+        .def_property_readonly("states_per_second", &ParallelDFTBuildStatistics::getStatesPerSecond, "Explored states per second")
+        .def("__str__", &ParallelDFTBuildStatistics::toString)
+    ;
 }
 
 template<typename ValueType>
@@ -55,10 +349,19 @@ void define_analysis_typed(py::module& m, std::string const& vt_suffix) {
         .def("get_partial_model", &ExplicitDFTModelBuilder<ValueType>::getModelApproximation, "Get partial model", py::arg("lower_bound"), py::arg("expected_time"))
     ;
 
+    py::class_<ParallelDFTModelBuilder<ValueType>, std::shared_ptr<ParallelDFTModelBuilder<ValueType>>>(m, ("ParallelDFTModelBuilder"+vt_suffix).c_str(), "Builder to generate explicit model from DFT with multiple threads")
+        .def(py::init<storm::dft::storage::DFT<ValueType> const&, storm::dft::storage::DftSymmetries const&, uint64_t>(), "Constructor", py::arg("dft"), py::arg("symmetries")=storm::dft::storage::DftSymmetries(), py::arg("threads")=0, py::keep_alive<1, 2>())
+        .def("build", &ParallelDFTModelBuilder<ValueType>::buildModel, "Build state space of model", py::call_guard<py::gil_scoped_release>())
+        .def("get_model", &ParallelDFTModelBuilder<ValueType>::getModel, "Get complete model")
+        .def_property_readonly("statistics", &ParallelDFTModelBuilder<ValueType>::getStatistics, "Statistics of the last build")
+    ;
+
     m.def(("_analyze_dft"+vt_suffix).c_str(), &analyzeDFT<ValueType>, "Analyze the DFT", py::arg("dft"), py::arg("properties"), py::arg("symred")=true, py::arg("allow_modularisation")=false, py::arg("relevant_events")=storm::dft::utility::RelevantEvents(), py::arg("allow_dc_for_relevant")=false);
 
     m.def(("_build_model"+vt_suffix).c_str(), &buildModel<ValueType>, "Build state-space model (CTMC or MA) for DFT", py::arg("dft"), py::arg("symmetries"), py::arg("relevant_events")=storm::dft::utility::RelevantEvents(), py::arg("allow_dc_for_relevant")=false);
 
+    m.def(("_build_model_parallel"+vt_suffix).c_str(), &buildModelParallel<ValueType>, "Build state-space model (CTMC or MA) for DFT with multiple threads", py::arg("dft"), py::arg("symmetries"), py::arg("relevant_events")=storm::dft::utility::RelevantEvents(), py::arg("allow_dc_for_relevant")=false, py::arg("threads")=0, py::call_guard<py::gil_scoped_release>());
+
     m.def(("_transform_dft"+vt_suffix).c_str(), &storm::dft::api::applyTransformations<ValueType>, "Apply transformations on DFT", py::arg("dft"), py::arg("unique_constant_be"), py::arg("binary_fdeps"), py::arg("exponential_distributions"));
 
     m.def(("_compute_dependency_conflicts"+vt_suffix).c_str(), &storm::dft::api::computeDependencyConflicts<ValueType>, "Set conflicts between FDEPs. Is used in analysis.", py::arg("dft"), py::arg("use_smt") = false, py::arg("solver_timeout") = 0);
@@ -4,6 +4,22 @@
 #include "storm-dft/simulator/DFTTraceSimulator.h"
 #include "storm-dft/api/storm-dft.h"
 #include "storm-dft/generator/DftNextStateGenerator.h"
+#include "storm-dft/storage/elements/BEExponential.h"
+#include <storm/exceptions/InvalidArgumentException.h>
+#include <storm/exceptions/NotSupportedException.h>
+#include <storm/utility/macros.h>
+
+#include <boost/math/distributions/normal.hpp>
+#include <boost/random/uniform_real_distribution.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <thread>
 
 
 template<typename ValueType> using Simulator = storm::dft::simulator::DFTTraceSimulator<ValueType>;
@@ -11,6 +27,228 @@ typedef storm::dft::storage::DFTStateGenerationInfo DFTStateInfo;
 typedef boost::mt19937 RandomGenerator;
 
 
+struct DFTSimulationResult {
+    std::vector<double> timeBounds;
+    // Estimated probability of a system failure within each time bound and the confidence interval
+    std::vector<double> unreliability;
+    std::vector<double> lowerBounds;
+    std::vector<double> upperBounds;
+    // Number of traces with a system failure within each time bound
+    std::vector<uint64_t> failedTraces;
+    uint64_t traces = 0;
+    uint64_t invalidTraces = 0;
+    double confidence = 0;
+    double time = 0;
+
+    double getTracesPerSecond() const {
+        return time > 0 ? traces / time : 0;
+    }
+};
+
+/*!
+ * Monte-Carlo simulation of many DFT traces with multiple threads.
+ * Traces are simulated in blocks, each with its own random generator seeded from the seed and the block index,
+ * thus the result does not depend on the number of threads.
+ * With forcing (failure biasing for rare failures), the time of the next BE failure is sampled conditioned on being before the largest time bound,
+ * and each trace is weighted with its likelihood ratio. This requires exponentially distributed BEs.
+ * Invalid traces (violating a SEQ) are discarded.
+ */
+class DFTBatchSimulator {
+public:
+    DFTBatchSimulator(storm::dft::storage::DFT<double> const& dft, DFTStateInfo const& stateGenerationInfo, bool forcing) : dft(dft), stateGenerationInfo(stateGenerationInfo), forcing(forcing) {
+    }
+
+    DFTSimulationResult simulate(std::vector<double> const& timeBounds, uint64_t numberOfTraces, unsigned int seed, uint64_t threads, double confidence) {
+        STORM_LOG_THROW(!timeBounds.empty(), storm::exceptions::InvalidArgumentException, "At least one time bound must be given.");
+        STORM_LOG_THROW(confidence > 0 && confidence < 1, storm::exceptions::InvalidArgumentException, "Confidence must be in (0,1).");
+        auto start = std::chrono::steady_clock::now();
+        std::vector<double> bounds = timeBounds;
+        std::sort(bounds.begin(), bounds.end());
+        double maxBound = bounds.back();
+
+        threads = threads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : threads;
+        uint64_t blocks = (numberOfTraces + blockSize - 1) / blockSize;
+        threads = std::max<uint64_t>(1, std::min<uint64_t>(threads, blocks));
+        std::vector<Accumulator> accumulators(threads, Accumulator(bounds.size()));
+        std::vector<std::exception_ptr> exceptions(threads);
+        std::atomic<uint64_t> next(0);
+        auto work = [&](uint64_t worker) {
+            try {
+                RandomGenerator generator;
+                Simulator<double> simulator(dft, stateGenerationInfo, generator);
+                Accumulator& accumulator = accumulators[worker];
+                for (uint64_t block = next++; block < blocks; block = next++) {
+                    std::seed_seq sequence{static_cast<uint64_t>(seed), block};
+                    std::array<uint32_t, 1> blockSeed;
+                    sequence.generate(blockSeed.begin(), blockSeed.end());
+                    generator.seed(blockSeed[0]);
+                    for (uint64_t trace = block * blockSize; trace < std::min(numberOfTraces, (block + 1) * blockSize); ++trace) {
+                        auto [failureTime, weight] = simulateTrace(simulator, generator, maxBound);
+                        if (std::isnan(failureTime)) {
+                            ++accumulator.invalid;
+                            continue;
+                        }
+                        ++accumulator.traces;
+                        for (uint64_t i = 0; i < bounds.size(); ++i) {
+                            if (failureTime <= bounds[i]) {
+                                ++accumulator.failed[i];
+                                accumulator.sum[i] += weight;
+                                accumulator.sumSquares[i] += weight * weight;
+                            }
+                        }
+                    }
+                }
+            } catch (...) {
+                exceptions[worker] = std::current_exception();
+            }
+        };
+        if (threads == 1) {
+            work(0);
+        } else {
+            std::vector<std::thread> workers;
+            for (uint64_t worker = 0; worker < threads; ++worker) {
+                workers.emplace_back(work, worker);
+            }
+            for (auto& worker : workers) {
+                worker.join();
+            }
+        }
+        for (auto const& exception : exceptions) {
+            if (exception) {
+                std::rethrow_exception(exception);
+            }
+        }
+
+        Accumulator total(bounds.size());
+        for (auto const& accumulator : accumulators) {
+            total.add(accumulator);
+        }
+        DFTSimulationResult result;
+        result.timeBounds = bounds;
+        result.traces = total.traces;
+        result.invalidTraces = total.invalid;
+        result.failedTraces = total.failed;
+        result.confidence = confidence;
+        double z = boost::math::quantile(boost::math::normal(), 0.5 + confidence / 2);
+        double n = total.traces;
+        for (uint64_t i = 0; i < bounds.size(); ++i) {
+            double estimate = n > 0 ? total.sum[i] / n : 0;
+            double lower = 0, upper = 1;
+            if (n > 0 && !forcing) {
+                // Wilson score interval
+                double center = (estimate + z * z / (2 * n)) / (1 + z * z / n);
+                double halfWidth = z / (1 + z * z / n) * std::sqrt(estimate * (1 - estimate) / n + z * z / (4 * n * n));
+                lower = center - halfWidth;
+                upper = center + halfWidth;
+            } else if (n > 1) {
+                // Normal approximation with the sample variance of the weighted indicators
+                double variance = std::max(0.0, (total.sumSquares[i] - n * estimate * estimate) / (n - 1));
+                double halfWidth = z * std::sqrt(variance / n);
+                lower = estimate - halfWidth;
+                upper = estimate + halfWidth;
+            }
+            result.unreliability.push_back(estimate);
+            result.lowerBounds.push_back(std::max(0.0, lower));
+            result.upperBounds.push_back(std::min(1.0, upper));
+        }
+        result.time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return result;
+    }
+
+private:
+    static constexpr uint64_t blockSize = 1024;
+
+    struct Accumulator {
+        Accumulator(uint64_t bounds) : failed(bounds, 0), sum(bounds, 0), sumSquares(bounds, 0) {
+        }
+
+        void add(Accumulator const& other) {
+            traces += other.traces;
+            invalid += other.invalid;
+            for (uint64_t i = 0; i < failed.size(); ++i) {
+                failed[i] += other.failed[i];
+                sum[i] += other.sum[i];
+                sumSquares[i] += other.sumSquares[i];
+            }
+        }
+
+        uint64_t traces = 0;
+        uint64_t invalid = 0;
+        std::vector<uint64_t> failed;
+        std::vector<double> sum;
+        std::vector<double> sumSquares;
+    };
+
+    // Returns the time of the system failure (infinity if there is none before the time bound, NaN for invalid traces) and the weight of the trace
+    std::pair<double, double> simulateTrace(Simulator<double>& simulator, RandomGenerator& generator, double maxBound) const {
+        simulator.resetToInitial();
+        double time = 0;
+        double weight = 1;
+        while (true) {
+            auto state = simulator.getCurrentState();
+            if (state->isInvalid()) {
+                return {std::numeric_limits<double>::quiet_NaN(), weight};
+            }
+            if (state->hasFailed(dft.getTopLevelIndex())) {
+                return {time, weight};
+            }
+            if (time > maxBound) {
+                return {std::numeric_limits<double>::infinity(), weight};
+            }
+            auto const& failable = state->getFailableElements();
+            bool dependency = false;
+            for (auto it = failable.begin(); it != failable.end(); ++it) {
+                dependency |= it.isFailureDueToDependency();
+            }
+            storm::dft::simulator::SimulationResult result;
+            if (!forcing || dependency) {
+                double stepTime;
+                std::tie(result, stepTime) = simulator.randomStep();
+                time += stepTime;
+            } else {
+                // Rates of the failable BEs
+                std::vector<double> rates;
+                double totalRate = 0;
+                for (auto it = failable.begin(); it != failable.end(); ++it) {
+                    auto be = it.asBE<double>(dft);
+                    STORM_LOG_THROW(be->beType() == storm::dft::storage::elements::BEType::EXPONENTIAL, storm::exceptions::NotSupportedException,
+                                    "Forcing is only supported for exponentially distributed BEs.");
+                    auto beExp = std::static_pointer_cast<storm::dft::storage::elements::BEExponential<double> const>(be);
+                    bool active = !dft.hasRepresentant(be->id()) || state->isActive(dft.getRepresentant(be->id()));
+                    rates.push_back(active ? beExp->activeFailureRate() : beExp->passiveFailureRate());
+                    totalRate += rates.back();
+                }
+                if (totalRate <= 0) {
+                    return {std::numeric_limits<double>::infinity(), weight};
+                }
+                // Sample the time of the next failure conditioned on being before the time bound
+                double probability = -std::expm1(-totalRate * (maxBound - time));
+                weight *= probability;
+                boost::random::uniform_real_distribution<double> uniform(0, 1);
+                time += -std::log1p(-uniform(generator) * probability) / totalRate;
+                // Choose the failing BE according to the rates
+                double choice = uniform(generator) * totalRate;
+                auto it = failable.begin();
+                for (uint64_t i = 0; i + 1 < rates.size() && choice >= rates[i]; ++i, ++it) {
+                    choice -= rates[i];
+                }
+                result = simulator.step(it, true);
+            }
+            if (result == storm::dft::simulator::SimulationResult::INVALID) {
+                return {std::numeric_limits<double>::quiet_NaN(), weight};
+            }
+            if (result == storm::dft::simulator::SimulationResult::UNSUCCESSFUL) {
+                // No further failures possible
+                return {std::numeric_limits<double>::infinity(), weight};
+            }
+        }
+    }
+
+    storm::dft::storage::DFT<double> const& dft;
+    DFTStateInfo const& stateGenerationInfo;
+    bool forcing;
+};
+
 void define_simulator(py::module& m) {
 
     // Simulation result
@@ -27,6 +265,37 @@ void define_simulator(py::module& m) {
             return RandomGenerator(seed);
         }, py::arg("seed"), "Initialize random number generator")
     ;
+
+    py::class_<DFTSimulationResult>(m, "DFTSimulationResult", "Result of a batch simulation of DFT traces")
+        .def_readonly("time_bounds", &DFTSimulationResult::timeBounds, "Time bounds (sorted)")
+        .def_readonly("unreliability", &DFTSimulationResult::unreliability, "Estimated probability of a system failure within each time bound")
+        .def_readonly("lower_bounds", &DFTSimulationResult::lowerBounds, "Lower bounds of the confidence intervals")
+        .def_readonly("upper_bounds", &DFTSimulationResult::upperBounds, "Upper bounds of the confidence intervals")
+        .def_readonly("failed_traces", &DFTSimulationResult::failedTraces, "Number of traces with a system failure within each time bound")
+        .def_readonly("nr_traces", &DFTSimulationResult::traces, "Number of valid traces")
+        .def_readonly("invalid_traces", &DFTSimulationResult::invalidTraces, "Number of discarded invalid traces")
+        .def_readonly("confidence", &DFTSimulationResult::confidence, "Confidence level of the intervals")
+        .def_readonly("time", &DFTSimulationResult::time, "Simulation time in seconds")
+        .def_property_readonly("traces_per_second", &DFTSimulationResult::getTracesPerSecond, "Simulated traces per second")
+    ;
+
+    m.def("_simulate_batch_double", [](storm::dft::storage::DFT<double> const& dft, DFTStateInfo const& stateGenerationInfo, std::vector<double> const& timeBounds, uint64_t numberOfTraces,
+                                       unsigned int seed, uint64_t threads, double confidence, bool forcing) {
+            return DFTBatchSimulator(dft, stateGenerationInfo, forcing).simulate(timeBounds, numberOfTraces, seed, threads, confidence);
+        }, py::arg("dft"), py::arg("state_generation_info"), py::arg("timebounds"), py::arg("nr_traces"), py::arg("seed") = 42, py::arg("threads") = 0, py::arg("confidence") = 0.95,
+        py::arg("forcing") = false, py::call_guard<py::gil_scoped_release>(), R"dox(
+        Simulate traces of the DFT with multiple threads and estimate the unreliability for each time bound.
+
+        :param dft: DFT
+        :param state_generation_info: State generation information
+        :param timebounds: Time bounds
+        :param nr_traces: Number of traces
+        :param seed: Seed for the random generators
+        :param threads: Number of threads, 0 for the number of hardware threads
+        :param confidence: Confidence level for the intervals
+        :param forcing: Sample failures conditioned on the time bound and weight traces with their likelihood ratio (failure biasing for rare failures)
+        :return: Estimates and confidence intervals
+        )dox");
 }
 
 
@@ -6,6 +6,8 @@
 #include "pomdp/transformations.h"
 #include "pomdp/memory.h"
 #include "pomdp/quantitative_analysis.h"
+#include "pomdp/belief_exploration.h"
+#include "pomdp/observation_split.h"
 #include <storm/adapters/RationalFunctionAdapter.h>
 
 PYBIND11_MODULE(pomdp, m) {
@@ -17,6 +19,7 @@ PYBIND11_MODULE(pomdp, m) {
 #endif
     define_tracker<double>(m, "Double");
     define_tracker<storm::RationalNumber>(m, "Exact");
+    define_observation_split(m);
     define_qualitative_policy_search<double>(m, "Double");
     define_qualitative_policy_search_nt(m);
     define_memory(m);
@@ -24,6 +27,7 @@ PYBIND11_MODULE(pomdp, m) {
     define_transformations<double>(m, "Double");
     define_transformations<storm::RationalNumber>(m, "Exact");
     define_belief_exploration<double>(m, "Double");
+    define_parallel_belief_exploration(m);
 
     define_transformations<storm::RationalFunction>(m, "Rf");
 }
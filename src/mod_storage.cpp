@@ -4,11 +4,14 @@
 #include "storage/dd.h"
 #include "storage/model.h"
 #include "storage/decomposition.h"
+#include "storage/parallel_decomposition.h"
 #include "storage/matrix.h"
+#include "storage/sliced_matrix.h"
 #include "storage/model_components.h"
 #include "storage/distribution.h"
 #include "storage/scheduler.h"
 #include "storage/prism.h"
+#include "storage/prism_slicing.h"
 #include "storage/jani.h"
 #include "storage/state.h"
 #include "src/storage/valuation.h"
@@ -43,12 +46,16 @@ PYBIND11_MODULE(storage, m) {
     define_sparse_matrix<storm::Interval>(m, "Interval");
     define_sparse_matrix<storm::RationalFunction>(m, "Parametric");
     define_sparse_matrix_nt(m);
+    define_sliced_matrix<double>(m, "");
+    define_sliced_matrix<float>(m, "Float");
+    define_mixed_precision_solver(m);
     define_symbolic_model<storm::dd::DdType::Sylvan>(m, "Sylvan");
     define_state<double>(m, "");
     define_state<storm::RationalNumber>(m, "Exact");
     define_state<storm::Interval>(m, "Interval");
     define_state<storm::RationalFunction>(m, "Parametric");
     define_prism(m);
+    define_prism_slicing(m);
     define_jani(m);
     define_jani_transformers(m);
     define_labeling(m);
@@ -58,6 +65,7 @@ PYBIND11_MODULE(storage, m) {
     define_scheduler<storm::RationalNumber>(m, "Exact");
     define_scheduler<storm::Interval>(m, "Interval");
     define_scheduler<storm::RationalFunction>(m, "Parametric");
+    define_induced_dtmc(m);
     define_distribution<double>(m, "");
     define_distribution<storm::RationalNumber>(m, "Exact");
     define_distribution<storm::Interval>(m, "Interval");
@@ -68,10 +76,21 @@ PYBIND11_MODULE(storage, m) {
     define_geometry<double>(m, "Double");
     define_geometry<storm::RationalNumber>(m, "Exact");
 
+    define_flat_decomposition(m);
     define_maximal_end_components(m);
     define_maximal_end_component_decomposition<double>(m, "_double");
     define_maximal_end_component_decomposition<storm::RationalNumber>(m, "_exact");
     define_maximal_end_component_decomposition<storm::Interval>(m, "_interval");
     define_maximal_end_component_decomposition<storm::RationalFunction>(m, "_ratfunc");
+    define_strongly_connected_components(m);
+    define_strongly_connected_component_decomposition<double>(m, "_double");
+    define_strongly_connected_component_decomposition<storm::RationalNumber>(m, "_exact");
+    define_strongly_connected_component_decomposition<storm::Interval>(m, "_interval");
+    define_strongly_connected_component_decomposition<storm::RationalFunction>(m, "_ratfunc");
+    define_parallel_decomposition_result(m);
+    define_parallel_decomposition<double>(m, "_double");
+    define_parallel_decomposition<storm::RationalNumber>(m, "_exact");
+    define_parallel_decomposition<storm::Interval>(m, "_interval");
+    define_parallel_decomposition<storm::RationalFunction>(m, "_ratfunc");
 
 }
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "common.h"
+
+#include <pybind11/numpy.h>
+
+#include "storm/storage/SparseMatrix.h"
+
+#include <vector>
+
+/**
+ * Helper function to expose a vector as NumPy array without copying.
+ * The owner is kept alive as long as the array exists and must own the vector.
+ * The array is read-only unless writeable is set, as pybind11 marks arrays with a base object as writeable.
+ */
+template<typename T>
+py::array_t<T> vectorAsNumpy(std::vector<T> const& vector, py::handle owner, bool writeable = false) {
+    py::array_t<T> result(vector.size(), vector.data(), owner);
+    if (!writeable) {
+        result.attr("flags").attr("writeable") = false;
+    }
+    return result;
+}
+
+/**
+ * Helper function to expose the values of a sparse matrix (in the order of its entries) as NumPy array without copying.
+ * The owner is kept alive as long as the array exists and must own the matrix.
+ * The array is read-only unless writeable is set.
+ */
+inline py::array_t<double> matrixValuesAsNumpy(storm::storage::SparseMatrix<double> const& matrix, py::handle owner, bool writeable = false) {
+    using Entry = storm::storage::MatrixEntry<storm::storage::SparseMatrix<double>::index_type, double>;
+    if (matrix.getEntryCount() == 0) {
+        return py::array_t<double>(0);
+    }
+    // Values are interleaved with the column indices
+    std::vector<py::ssize_t> shape = {static_cast<py::ssize_t>(matrix.getEntryCount())};
+    std::vector<py::ssize_t> strides = {static_cast<py::ssize_t>(sizeof(Entry))};
+    py::array_t<double> result(shape, strides, &matrix.begin()->getValue(), owner);
+    if (!writeable) {
+        result.attr("flags").attr("writeable") = false;
+    }
+    return result;
+}
@@ -0,0 +1,538 @@
+#include "belief_exploration.h"
+#include "observation_split.h"
+
+#include <storm/adapters/RationalFunctionAdapter.h>
+#include <storm/models/sparse/Mdp.h>
+#include <storm/models/sparse/Pomdp.h>
+#include <storm/models/sparse/StandardRewardModel.h>
+#include <storm/storage/BitVector.h>
+#include <storm/storage/SparseMatrix.h>
+#include <storm/storage/sparse/ModelComponents.h>
+#include <storm/utility/constants.h>
+#include <storm/utility/macros.h>
+#include <storm/exceptions/InvalidArgumentException.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+using Pomdp = storm::models::sparse::Pomdp<double>;
+using Mdp = storm::models::sparse::Mdp<double>;
+// Sparse belief: states (sorted) with their probabilities
+using Belief = std::vector<std::pair<uint64_t, double>>;
+
+struct ParallelBeliefExplorationOptions {
+    // Number of worker threads, 0 for the number of hardware threads
+    uint64_t threads = 0;
+    // Exploration stops once this number of beliefs has been discovered, 0 for no limit
+    uint64_t maxBeliefs = 100000;
+    // Exploration time limit in seconds, 0 for no limit
+    double timeLimit = 0;
+    // Probabilities are stored as fixed-point multiples of this value, beliefs which are equal after rounding are merged.
+    // Rounded beliefs do not necessarily sum up to one.
+    double precision = 1e-9;
+};
+
+struct BeliefExplorationStatistics {
+    uint64_t exploredBeliefs = 0;
+    uint64_t discoveredBeliefs = 0;
+    uint64_t levels = 0;
+    uint64_t threads = 0;
+    double explorationTime = 0;
+    uint64_t distinctSupports = 0;
+    // Estimated memory of the belief store in bytes
+    uint64_t beliefMemory = 0;
+
+    double getExplorationRate() const {
+        return explorationTime > 0 ? exploredBeliefs / explorationTime : 0;
+    }
+
+    double getBytesPerBelief() const {
+        return discoveredBeliefs > 0 ? static_cast<double>(beliefMemory) / discoveredBeliefs : 0;
+    }
+
+    std::string toString() const {
+        std::stringstream stream;
+        stream << "Explored " << exploredBeliefs << " of " << discoveredBeliefs << " beliefs in " << levels << " levels with " << threads << " threads in "
+               << explorationTime << "s (" << getExplorationRate() << " beliefs/s), " << distinctSupports << " distinct supports, " << getBytesPerBelief()
+               << " bytes per belief";
+        return stream.str();
+    }
+};
+
+// Fixed-point probability in multiples of the precision
+using QuantisedValue = uint32_t;
+
+/*!
+ * Thread-safe store for beliefs in compact form.
+ * Supports (sorted sets of states) are interned and shared among all beliefs with the same support,
+ * probabilities are stored as fixed-point multiples of the precision.
+ * Beliefs are hashed and compared on this compact form. Both tables are split into shards with separate locks.
+ */
+class CompactBeliefStore {
+public:
+    CompactBeliefStore(double precision) : precision(precision) {
+    }
+
+    // Returns the id of the belief and whether it was inserted. The support must be sorted.
+    std::pair<uint64_t, bool> insert(std::vector<uint32_t> const& support, std::vector<QuantisedValue> const& values) {
+        uint64_t supportId = internSupport(support);
+        uint64_t shardIndex = hashBelief(supportId, values.data(), values.size()) % shardCount;
+        BeliefShard& shard = beliefShards[shardIndex];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        // Append the belief and remove it again if it already exists
+        uint64_t local = shard.supportIds.size();
+        shard.supportIds.push_back(supportId);
+        shard.values.insert(shard.values.end(), values.begin(), values.end());
+        shard.valueOffsets.push_back(shard.values.size());
+        auto [it, inserted] = shard.index.insert(local);
+        if (!inserted) {
+            shard.supportIds.pop_back();
+            shard.valueOffsets.pop_back();
+            shard.values.resize(shard.valueOffsets.back());
+            return {shard.ids[*it], false};
+        }
+        uint64_t id = counter++;
+        shard.ids.push_back(id);
+        std::unique_lock<std::shared_mutex> locationLock(locationMutex);
+        if (locations.size() <= id) {
+            locations.resize(id + 1);
+        }
+        locations[id] = local * shardCount + shardIndex;
+        return {id, true};
+    }
+
+    Belief get(uint64_t id) const {
+        uint64_t location;
+        {
+            std::shared_lock<std::shared_mutex> locationLock(locationMutex);
+            location = locations[id];
+        }
+        BeliefShard const& shard = beliefShards[location % shardCount];
+        uint64_t local = location / shardCount;
+        uint64_t supportId;
+        std::vector<QuantisedValue> values;
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            supportId = shard.supportIds[local];
+            values.assign(shard.values.begin() + shard.valueOffsets[local], shard.values.begin() + shard.valueOffsets[local + 1]);
+        }
+        SupportShard const& supportShard = supportShards[supportId % shardCount];
+        uint64_t supportLocal = supportId / shardCount;
+        Belief belief;
+        belief.reserve(values.size());
+        std::lock_guard<std::mutex> lock(supportShard.mutex);
+        for (uint64_t i = 0; i < values.size(); ++i) {
+            belief.emplace_back(supportShard.states[supportShard.offsets[supportLocal] + i], values[i] * precision);
+        }
+        return belief;
+    }
+
+    uint64_t size() const {
+        return counter;
+    }
+
+    uint64_t getNumberOfSupports() const {
+        uint64_t supports = 0;
+        for (auto const& shard : supportShards) {
+            supports += shard.offsets.size() - 1;
+        }
+        return supports;
+    }
+
+    // Estimated memory in bytes; hash tables are counted with one pointer per bucket and three words per node.
+    // Must not be called concurrently with insert.
+    uint64_t getMemoryUsage() const {
+        uint64_t bytes = locations.capacity() * sizeof(uint64_t);
+        for (auto const& shard : supportShards) {
+            bytes += shard.states.capacity() * sizeof(uint32_t) + shard.offsets.capacity() * sizeof(uint64_t);
+            bytes += shard.index.bucket_count() * sizeof(void*) + shard.index.size() * 3 * sizeof(void*);
+        }
+        for (auto const& shard : beliefShards) {
+            bytes += shard.values.capacity() * sizeof(QuantisedValue) + (shard.supportIds.capacity() + shard.valueOffsets.capacity() + shard.ids.capacity()) * sizeof(uint64_t);
+            bytes += shard.index.bucket_count() * sizeof(void*) + shard.index.size() * 3 * sizeof(void*);
+        }
+        return bytes;
+    }
+
+private:
+    static constexpr std::size_t shardCount = 64;
+
+    static std::size_t combine(std::size_t seed, std::size_t value) {
+        return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+    }
+
+    static std::size_t hashSupport(uint32_t const* states, uint64_t size) {
+        std::size_t seed = size;
+        for (uint64_t i = 0; i < size; ++i) {
+            seed = combine(seed, states[i]);
+        }
+        return seed;
+    }
+
+    static std::size_t hashBelief(uint64_t supportId, QuantisedValue const* values, uint64_t size) {
+        std::size_t seed = std::hash<uint64_t>()(supportId);
+        for (uint64_t i = 0; i < size; ++i) {
+            seed = combine(seed, values[i]);
+        }
+        return seed;
+    }
+
+    // Entries of both tables are local indices into the flat arrays of their shard, hashed and compared on the referenced data
+    struct SupportShard {
+        struct Hash {
+            SupportShard const* shard;
+            std::size_t operator()(uint64_t local) const {
+                return hashSupport(shard->states.data() + shard->offsets[local], shard->offsets[local + 1] - shard->offsets[local]);
+            }
+        };
+        struct Equal {
+            SupportShard const* shard;
+            bool operator()(uint64_t first, uint64_t second) const {
+                auto const& offsets = shard->offsets;
+                return std::equal(shard->states.begin() + offsets[first], shard->states.begin() + offsets[first + 1], shard->states.begin() + offsets[second],
+                                  shard->states.begin() + offsets[second + 1]);
+            }
+        };
+
+        SupportShard() : offsets({0}), index(0, Hash{this}, Equal{this}) {
+        }
+
+        mutable std::mutex mutex;
+        std::vector<uint32_t> states;
+        std::vector<uint64_t> offsets;
+        std::unordered_set<uint64_t, Hash, Equal> index;
+    };
+
+    struct BeliefShard {
+        struct Hash {
+            BeliefShard const* shard;
+            std::size_t operator()(uint64_t local) const {
+                return hashBelief(shard->supportIds[local], shard->values.data() + shard->valueOffsets[local], shard->valueOffsets[local + 1] - shard->valueOffsets[local]);
+            }
+        };
+        struct Equal {
+            BeliefShard const* shard;
+            bool operator()(uint64_t first, uint64_t second) const {
+                auto const& offsets = shard->valueOffsets;
+                return shard->supportIds[first] == shard->supportIds[second] &&
+                       std::equal(shard->values.begin() + offsets[first], shard->values.begin() + offsets[first + 1], shard->values.begin() + offsets[second],
+                                  shard->values.begin() + offsets[second + 1]);
+            }
+        };
+
+        BeliefShard() : valueOffsets({0}), index(0, Hash{this}, Equal{this}) {
+        }
+
+        mutable std::mutex mutex;
+        std::vector<uint64_t> supportIds;
+        std::vector<QuantisedValue> values;
+        std::vector<uint64_t> valueOffsets;
+        // Belief id for each local index
+        std::vector<uint64_t> ids;
+        std::unordered_set<uint64_t, Hash, Equal> index;
+    };
+
+    // Returns the id of the support, which encodes its shard and local index
+    uint64_t internSupport(std::vector<uint32_t> const& support) {
+        uint64_t shardIndex = hashSupport(support.data(), support.size()) % shardCount;
+        SupportShard& shard = supportShards[shardIndex];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        uint64_t local = shard.offsets.size() - 1;
+        shard.states.insert(shard.states.end(), support.begin(), support.end());
+        shard.offsets.push_back(shard.states.size());
+        auto [it, inserted] = shard.index.insert(local);
+        if (!inserted) {
+            shard.offsets.pop_back();
+            shard.states.resize(shard.offsets.back());
+            local = *it;
+        }
+        return local * shardCount + shardIndex;
+    }
+
+    double precision;
+    std::array<SupportShard, shardCount> supportShards;
+    std::array<BeliefShard, shardCount> beliefShards;
+    // Shard and local index for each belief id
+    std::vector<uint64_t> locations;
+    mutable std::shared_mutex locationMutex;
+    std::atomic<uint64_t> counter{0};
+};
+
+struct ParallelBeliefExplorationResult {
+    std::shared_ptr<Mdp> beliefMdp;
+    std::shared_ptr<CompactBeliefStore> beliefs;
+    // Beliefs which were discovered but not expanded. They are absorbing in the belief MDP.
+    storm::storage::BitVector cutoffStates;
+    BeliefExplorationStatistics statistics;
+};
+
+/*!
+ * Level-wise exploration of the belief MDP of a (canonic) POMDP with multiple threads.
+ * The beliefs of the current frontier are distributed over the workers, which compute the successor beliefs of all actions
+ * and look them up in a shared hash table. Newly discovered beliefs form the next frontier.
+ * If a limit is reached, the remaining beliefs are not expanded and become absorbing (label 'cutoff').
+ * State ids of the belief MDP depend on the interleaving of the workers unless a single thread is used.
+ */
+class ParallelBeliefExplorer {
+public:
+    ParallelBeliefExplorer(Pomdp const& pomdp, ParallelBeliefExplorationOptions const& options) : pomdp(pomdp), options(options), splitTransitions(pomdp) {
+        STORM_LOG_THROW(pomdp.getInitialStates().getNumberOfSetBits() == 1, storm::exceptions::InvalidArgumentException, "The POMDP must have a unique initial state.");
+        STORM_LOG_THROW(options.precision > 0 && options.precision < 0.5, storm::exceptions::InvalidArgumentException, "Precision must be positive and smaller than 0.5.");
+        STORM_LOG_THROW(options.precision * std::numeric_limits<QuantisedValue>::max() >= 1, storm::exceptions::InvalidArgumentException,
+                        "Precision is too small for the fixed-point representation of probabilities.");
+        STORM_LOG_THROW(pomdp.getNumberOfStates() <= std::numeric_limits<uint32_t>::max(), storm::exceptions::InvalidArgumentException, "The POMDP has too many states.");
+        threads = options.threads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : options.threads;
+        store = std::make_shared<CompactBeliefStore>(options.precision);
+    }
+
+    ParallelBeliefExplorationResult explore() {
+        auto start = std::chrono::steady_clock::now();
+        deadline = options.timeLimit > 0 ? start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(options.timeLimit))
+                                         : std::chrono::steady_clock::time_point::max();
+        ParallelBeliefExplorationResult result;
+        result.statistics.threads = threads;
+
+        store->insert({static_cast<uint32_t>(*pomdp.getInitialStates().begin())}, {static_cast<QuantisedValue>(std::llround(1 / options.precision))});
+        std::vector<uint64_t> frontier = {0};
+        while (!frontier.empty() && !limitReached()) {
+            transitions.resize(store->size());
+            expanded.resize(store->size(), 0);
+            std::vector<std::vector<uint64_t>> discovered(threads);
+            std::atomic<uint64_t> next(0);
+            auto work = [&](uint64_t worker) {
+                for (uint64_t index = next++; index < frontier.size(); index = next++) {
+                    if (limitReached()) {
+                        break;
+                    }
+                    expand(frontier[index], discovered[worker]);
+                }
+            };
+            if (threads == 1) {
+                work(0);
+            } else {
+                std::vector<std::thread> workers;
+                for (uint64_t worker = 0; worker < threads; ++worker) {
+                    workers.emplace_back(work, worker);
+                }
+                for (auto& worker : workers) {
+                    worker.join();
+                }
+            }
+            // Collect the new beliefs
+            frontier.clear();
+            for (auto const& newBeliefs : discovered) {
+                frontier.insert(frontier.end(), newBeliefs.begin(), newBeliefs.end());
+            }
+            std::sort(frontier.begin(), frontier.end());
+            ++result.statistics.levels;
+        }
+        transitions.resize(store->size());
+        expanded.resize(store->size(), 0);
+
+        result.statistics.discoveredBeliefs = store->size();
+        result.statistics.exploredBeliefs = std::count(expanded.begin(), expanded.end(), 1);
+        result.statistics.explorationTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        result.statistics.distinctSupports = store->getNumberOfSupports();
+        result.statistics.beliefMemory = store->getMemoryUsage();
+        result.cutoffStates = storm::storage::BitVector(store->size());
+        for (uint64_t id = 0; id < store->size(); ++id) {
+            result.cutoffStates.set(id, !expanded[id]);
+        }
+        result.beliefMdp = buildBeliefMdp(result.cutoffStates);
+        result.beliefs = store;
+        return result;
+    }
+
+private:
+    Pomdp const& pomdp;
+    ParallelBeliefExplorationOptions options;
+    ObservationSplitTransitions<double> splitTransitions;
+    uint64_t threads;
+    std::chrono::steady_clock::time_point deadline;
+    std::shared_ptr<CompactBeliefStore> store;
+    // Successors (belief id and probability) for each action of each belief
+    std::vector<std::vector<std::vector<std::pair<uint64_t, double>>>> transitions;
+    std::vector<char> expanded;
+
+    bool limitReached() const {
+        return (options.maxBeliefs > 0 && store->size() >= options.maxBeliefs) || std::chrono::steady_clock::now() >= deadline;
+    }
+
+    void expand(uint64_t id, std::vector<uint64_t>& discovered) {
+        Belief belief = store->get(id);
+        uint64_t actions = splitTransitions.getNumberOfActions(belief.front().first);
+        std::vector<std::vector<std::pair<uint64_t, double>>> rows(actions);
+        for (uint64_t action = 0; action < actions; ++action) {
+            // Unnormalized successor beliefs per observation
+            std::map<uint32_t, std::map<uint64_t, double>> successors;
+            for (auto const& [state, probability] : belief) {
+                uint64_t row = splitTransitions.getRow(state, action);
+                for (uint64_t slice = splitTransitions.rowSliceOffsets[row]; slice < splitTransitions.rowSliceOffsets[row + 1]; ++slice) {
+                    auto& successor = successors[splitTransitions.sliceObservations[slice]];
+                    for (uint64_t entry = splitTransitions.sliceEntryOffsets[slice]; entry < splitTransitions.sliceEntryOffsets[slice + 1]; ++entry) {
+                        successor[splitTransitions.columns[entry]] += probability * splitTransitions.values[entry];
+                    }
+                }
+            }
+            for (auto const& [observation, successor] : successors) {
+                double observationProbability = 0;
+                for (auto const& entry : successor) {
+                    observationProbability += entry.second;
+                }
+                std::vector<uint32_t> support;
+                std::vector<QuantisedValue> values;
+                auto mostLikely = successor.begin();
+                for (auto it = successor.begin(); it != successor.end(); ++it) {
+                    uint64_t quantised = std::llround(it->second / observationProbability / options.precision);
+                    if (quantised > 0) {
+                        support.push_back(it->first);
+                        values.push_back(quantised);
+                    }
+                    if (it->second > mostLikely->second) {
+                        mostLikely = it;
+                    }
+                }
+                // Keep the most likely state if all probabilities are rounded to zero
+                if (support.empty()) {
+                    support.push_back(mostLikely->first);
+                    values.push_back(1);
+                }
+                auto [successorId, inserted] = store->insert(support, values);
+                if (inserted) {
+                    discovered.push_back(successorId);
+                }
+                rows[action].emplace_back(successorId, observationProbability);
+            }
+            std::sort(rows[action].begin(), rows[action].end());
+        }
+        transitions[id] = std::move(rows);
+        expanded[id] = 1;
+    }
+
+    std::shared_ptr<Mdp> buildBeliefMdp(storm::storage::BitVector const& cutoffStates) const {
+        uint64_t beliefCount = store->size();
+        auto const& groups = pomdp.getTransitionMatrix().getRowGroupIndices();
+        storm::storage::SparseMatrixBuilder<double> builder(0, beliefCount, 0, false, true, beliefCount);
+        std::unordered_map<std::string, std::vector<double>> pomdpRewards;
+        for (auto const& [name, rewardModel] : pomdp.getRewardModels()) {
+            pomdpRewards[name] = rewardModel.getTotalRewardVector(pomdp.getTransitionMatrix());
+        }
+        std::unordered_map<std::string, std::vector<double>> beliefRewards;
+        // A belief has a label if all states in its support have it
+        std::vector<std::pair<std::string, storm::storage::BitVector>> beliefLabels;
+        for (auto const& label : pomdp.getStateLabeling().getLabels()) {
+            if (label != "init") {
+                beliefLabels.emplace_back(label, storm::storage::BitVector(beliefCount));
+            }
+        }
+        uint64_t row = 0;
+        for (uint64_t id = 0; id < beliefCount; ++id) {
+            Belief belief = store->get(id);
+            for (auto& [label, beliefStates] : beliefLabels) {
+                storm::storage::BitVector const& labelStates = pomdp.getStateLabeling().getStates(label);
+                beliefStates.set(id, std::all_of(belief.begin(), belief.end(), [&labelStates](auto const& entry) { return labelStates.get(entry.first); }));
+            }
+            builder.newRowGroup(row);
+            if (cutoffStates.get(id)) {
+                builder.addNextValue(row, id, storm::utility::one<double>());
+                for (auto const& [name, rewards] : pomdpRewards) {
+                    beliefRewards[name].push_back(storm::utility::zero<double>());
+                }
+                ++row;
+                continue;
+            }
+            for (uint64_t action = 0; action < transitions[id].size(); ++action) {
+                for (auto const& [successor, probability] : transitions[id][action]) {
+                    builder.addNextValue(row, successor, probability);
+                }
+                for (auto const& [name, rewards] : pomdpRewards) {
+                    double reward = 0;
+                    for (auto const& [state, probability] : belief) {
+                        reward += probability * rewards[groups[state] + action];
+                    }
+                    beliefRewards[name].push_back(reward);
+                }
+                ++row;
+            }
+        }
+
+        storm::models::sparse::StateLabeling labeling(beliefCount);
+        for (auto& [label, beliefStates] : beliefLabels) {
+            labeling.addLabel(label, std::move(beliefStates));
+        }
+        storm::storage::BitVector initialStates(beliefCount);
+        initialStates.set(0);
+        labeling.addLabel("init", std::move(initialStates));
+        labeling.addLabel("cutoff", cutoffStates);
+
+        std::unordered_map<std::string, storm::models::sparse::StandardRewardModel<double>> rewardModels;
+        for (auto& [name, rewards] : beliefRewards) {
+            rewardModels.emplace(name, storm::models::sparse::StandardRewardModel<double>(std::nullopt, std::move(rewards)));
+        }
+        storm::storage::sparse::ModelComponents<double> components(builder.build(0, beliefCount, beliefCount), std::move(labeling), std::move(rewardModels));
+        return std::make_shared<Mdp>(std::move(components));
+    }
+};
+
+void define_parallel_belief_exploration(py::module& m) {
+    py::class_<ParallelBeliefExplorationOptions>(m, "ParallelBeliefExplorationOptions", "Options for the parallel exploration of belief MDPs")
+        .def(py::init<>())
+        .def_readwrite("threads", &ParallelBeliefExplorationOptions::threads, "Number of threads, 0 for the number of hardware threads")
+        .def_readwrite("max_beliefs", &ParallelBeliefExplorationOptions::maxBeliefs, "Maximal number of discovered beliefs, 0 for no limit")
+        .def_readwrite("time_limit", &ParallelBeliefExplorationOptions::timeLimit, "Time limit in seconds, 0 for no limit")
+        .def_readwrite("precision", &ParallelBeliefExplorationOptions::precision, "Probabilities are stored as fixed-point multiples of this value (at least 2^-32 and smaller than 0.5), beliefs are compared after rounding. Rounded beliefs do not necessarily sum up to one.")
+    ;
+
+    py::class_<BeliefExplorationStatistics>(m, "BeliefExplorationStatistics", "Statistics of a belief MDP exploration")
+        .def_readonly("explored_beliefs", &BeliefExplorationStatistics::exploredBeliefs, "Number of expanded beliefs")
+        .def_readonly("discovered_beliefs", &BeliefExplorationStatistics::discoveredBeliefs, "Number of discovered beliefs")
+        .def_readonly("levels", &BeliefExplorationStatistics::levels, "Number of explored levels (breadth-first)")
+        .def_readonly("threads", &BeliefExplorationStatistics::threads, "Number of threads")
+        .def_readonly("exploration_time", &BeliefExplorationStatistics::explorationTime, "Exploration time in seconds")
+        .def_property_readonly("exploration_rate", &BeliefExplorationStatistics::getExplorationRate, "Explored beliefs per second")
+        .def_readonly("distinct_supports", &BeliefExplorationStatistics::distinctSupports, "Number of distinct supports shared by the stored beliefs")
+        .def_readonly("belief_memory", &BeliefExplorationStatistics::beliefMemory, "Estimated memory of the belief store in bytes")
+        .def_property_readonly("bytes_per_belief", &BeliefExplorationStatistics::getBytesPerBelief, "Estimated memory of the belief store per discovered belief in bytes")
+        .def("__str__", &BeliefExplorationStatistics::toString)
+    ;
+
+    py::class_<ParallelBeliefExplorationResult>(m, "ParallelBeliefExplorationResult", "Result of the parallel exploration of a belief MDP")
+        .def_readonly("belief_mdp", &ParallelBeliefExplorationResult::beliefMdp, "Explored belief MDP, unexpanded beliefs are absorbing and labelled 'cutoff'")
+        .def_readonly("cutoff_states", &ParallelBeliefExplorationResult::cutoffStates, "States of the belief MDP which were not expanded")
+        .def_readonly("statistics", &ParallelBeliefExplorationResult::statistics, "Exploration statistics")
+        .def("get_belief", [](ParallelBeliefExplorationResult const& result, uint64_t state) {
+                STORM_LOG_THROW(state < result.beliefs->size(), storm::exceptions::InvalidArgumentException, "State " << state << " does not exist.");
+                Belief compactBelief = result.beliefs->get(state);
+                std::map<uint64_t, double> belief(compactBelief.begin(), compactBelief.end());
+                return belief;
+            }, py::arg("state"), "Get the belief (distribution over POMDP states) of a state of the belief MDP. Probabilities are rounded to multiples of the precision and do not necessarily sum up to one.")
+    ;
+
+    m.def("explore_belief_mdp_parallel", [](Pomdp const& pomdp, ParallelBeliefExplorationOptions const& options) {
+            return ParallelBeliefExplorer(pomdp, options).explore();
+        }, py::arg("pomdp"), py::arg("options") = ParallelBeliefExplorationOptions(), py::call_guard<py::gil_scoped_release>(), R"dox(
+
+        Explore the belief MDP of a canonic POMDP with multiple threads.
+        Labels of the POMDP are lifted to beliefs whose support only contains labelled states, rewards are lifted by expectation.
+        If a limit is reached, the remaining beliefs become absorbing and are labelled 'cutoff'; model checking the belief MDP
+        then yields bounds by treating cutoff beliefs as bad or good.
+
+        This is a standalone alternative to the exploration inside BeliefExplorationModelChecker, which stays sequential.
+        The exploration rate is reported in the statistics of the result instead of the status of the model checker.
+
+        :param SparsePomdp pomdp: Canonic POMDP with a unique initial state
+        :param ParallelBeliefExplorationOptions options: Options
+        :return: Result containing the belief MDP and exploration statistics
+        )dox");
+}
@@ -0,0 +1,4 @@
+#pragma once
+#include "common.h"
+
+void define_parallel_belief_exploration(py::module& m);
@@ -0,0 +1,44 @@
+#include "observation_split.h"
+#include "src/numpy_helpers.h"
+
+#include <storm/exceptions/InvalidArgumentException.h>
+#include <storm/utility/macros.h>
+
+using Transitions = ObservationSplitTransitions<double>;
+
+void define_observation_split(py::module& m) {
+    py::class_<Transitions>(m, "ObservationSplitTransitions", R"dox(
+        Transitions of a POMDP where each row is split by the observation of the successor states.
+
+        The slices of row r are row_slice_offsets[r] to row_slice_offsets[r+1] with observations slice_observations,
+        the entries of slice i are slice_entry_offsets[i] to slice_entry_offsets[i+1] in columns and values.
+        )dox")
+        .def(py::init<storm::models::sparse::Pomdp<double> const&>(), py::arg("pomdp"), py::call_guard<py::gil_scoped_release>())
+        .def_property_readonly("nr_slices", &Transitions::getNumberOfSlices, "Number of slices")
+        .def("get_row", [](Transitions const& transitions, uint64_t state, uint64_t action) {
+                STORM_LOG_THROW(state + 1 < transitions.rowGroupIndices.size() && action < transitions.getNumberOfActions(state), storm::exceptions::InvalidArgumentException,
+                                "Action " << action << " of state " << state << " does not exist.");
+                return transitions.getRow(state, action);
+            }, py::arg("state"), py::arg("action"), "Get the row of the state and the (local) action")
+        .def("get_observations", [](Transitions const& transitions, uint64_t row) {
+                STORM_LOG_THROW(row + 1 < transitions.rowSliceOffsets.size(), storm::exceptions::InvalidArgumentException, "Row " << row << " does not exist.");
+                return std::vector<uint32_t>(transitions.sliceObservations.begin() + transitions.rowSliceOffsets[row], transitions.sliceObservations.begin() + transitions.rowSliceOffsets[row + 1]);
+            }, py::arg("row"), "Get the observations of the successors of the row")
+        .def("get_successors", [](Transitions const& transitions, uint64_t row, uint32_t observation) {
+                STORM_LOG_THROW(row + 1 < transitions.rowSliceOffsets.size(), storm::exceptions::InvalidArgumentException, "Row " << row << " does not exist.");
+                std::vector<std::pair<uint64_t, double>> successors;
+                uint64_t slice = transitions.findSlice(row, observation);
+                if (slice < transitions.getNumberOfSlices()) {
+                    for (uint64_t entry = transitions.sliceEntryOffsets[slice]; entry < transitions.sliceEntryOffsets[slice + 1]; ++entry) {
+                        successors.emplace_back(transitions.columns[entry], transitions.values[entry]);
+                    }
+                }
+                return successors;
+            }, py::arg("row"), py::arg("observation"), "Get the successors (state and probability) of the row with the given observation")
+        .def_property_readonly("row_slice_offsets", [](py::object const& self) { return vectorAsNumpy(self.cast<Transitions const&>().rowSliceOffsets, self); }, "First slice of each row (NumPy view)")
+        .def_property_readonly("slice_observations", [](py::object const& self) { return vectorAsNumpy(self.cast<Transitions const&>().sliceObservations, self); }, "Observation of each slice (NumPy view)")
+        .def_property_readonly("slice_entry_offsets", [](py::object const& self) { return vectorAsNumpy(self.cast<Transitions const&>().sliceEntryOffsets, self); }, "First entry of each slice (NumPy view)")
+        .def_property_readonly("columns", [](py::object const& self) { return vectorAsNumpy(self.cast<Transitions const&>().columns, self); }, "Successor state of each entry (NumPy view)")
+        .def_property_readonly("values", [](py::object const& self) { return vectorAsNumpy(self.cast<Transitions const&>().values, self); }, "Probability of each entry (NumPy view)")
+    ;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "common.h"
+
+#include <storm/models/sparse/Pomdp.h>
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+/*!
+ * Transitions of a POMDP where each row (state and action) is split into slices by the observation of the successor states.
+ * The slices are stored in CSR format: the slices of row r are rowSliceOffsets[r] to rowSliceOffsets[r+1] (sorted by observation)
+ * and the entries of slice i are sliceEntryOffsets[i] to sliceEntryOffsets[i+1].
+ * A belief update for an action and an observation thus only visits the relevant entries.
+ */
+template<typename ValueType>
+class ObservationSplitTransitions {
+public:
+    ObservationSplitTransitions(storm::models::sparse::Pomdp<ValueType> const& pomdp) : rowGroupIndices(pomdp.getTransitionMatrix().getRowGroupIndices()) {
+        auto const& matrix = pomdp.getTransitionMatrix();
+        rowSliceOffsets.reserve(matrix.getRowCount() + 1);
+        columns.reserve(matrix.getEntryCount());
+        values.reserve(matrix.getEntryCount());
+        rowSliceOffsets.push_back(0);
+        sliceEntryOffsets.push_back(0);
+        for (uint64_t row = 0; row < matrix.getRowCount(); ++row) {
+            std::map<uint32_t, std::vector<std::pair<uint64_t, ValueType>>> successors;
+            for (auto const& entry : matrix.getRow(row)) {
+                successors[pomdp.getObservation(entry.getColumn())].emplace_back(entry.getColumn(), entry.getValue());
+            }
+            for (auto const& [observation, slice] : successors) {
+                sliceObservations.push_back(observation);
+                for (auto const& [column, value] : slice) {
+                    columns.push_back(column);
+                    values.push_back(value);
+                }
+                sliceEntryOffsets.push_back(columns.size());
+            }
+            rowSliceOffsets.push_back(sliceObservations.size());
+        }
+    }
+
+    uint64_t getRow(uint64_t state, uint64_t action) const {
+        return rowGroupIndices[state] + action;
+    }
+
+    uint64_t getNumberOfActions(uint64_t state) const {
+        return rowGroupIndices[state + 1] - rowGroupIndices[state];
+    }
+
+    // Returns the slice of the row with the given observation or getNumberOfSlices() if the observation is impossible
+    uint64_t findSlice(uint64_t row, uint32_t observation) const {
+        auto begin = sliceObservations.begin() + rowSliceOffsets[row];
+        auto end = sliceObservations.begin() + rowSliceOffsets[row + 1];
+        auto it = std::lower_bound(begin, end, observation);
+        return (it == end || *it != observation) ? getNumberOfSlices() : it - sliceObservations.begin();
+    }
+
+    uint64_t getNumberOfSlices() const {
+        return sliceObservations.size();
+    }
+
+    std::vector<uint64_t> rowGroupIndices;
+    std::vector<uint64_t> rowSliceOffsets;
+    std::vector<uint32_t> sliceObservations;
+    std::vector<uint64_t> sliceEntryOffsets;
+    std::vector<uint64_t> columns;
+    std::vector<ValueType> values;
+};
+
+void define_observation_split(py::module& m);
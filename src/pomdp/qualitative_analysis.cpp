@@ -4,6 +4,13 @@
 #include <storm-pomdp/analysis/QualitativeAnalysisOnGraphs.h>
 #include <storm-pomdp/analysis/WinningRegionQueryInterface.h>
 #include <storm/logic/Formula.h>
+#include <storm/exceptions/InvalidArgumentException.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <thread>
 
 template<typename ValueType> using SparsePomdp = storm::models::sparse::Pomdp<ValueType>;
 
@@ -20,6 +27,97 @@ std::shared_ptr<storm::pomdp::IterativePolicySearch<ValueType>> createWinningReg
     return std::make_shared<storm::pomdp::IterativePolicySearch<ValueType>>(pomdp, targetStates, surelyNotAlmostSurelyReachTarget, smtSolverFactory, options);
 }
 
+struct QualitativePortfolioConfigurationResult {
+    uint64_t lookahead;
+    // Whether the configuration was run before the result was proven
+    bool started = false;
+    bool initialStatesWinning = false;
+    double time = 0;
+};
+
+struct QualitativePortfolioResult {
+    std::optional<storm::pomdp::WinningRegion> winningRegion;
+    bool initialStatesWinning = false;
+    // Index of the configuration which proved the initial states winning
+    std::optional<uint64_t> winner;
+    std::vector<QualitativePortfolioConfigurationResult> configurations;
+};
+
+/*!
+ * Run iterative policy searches with different lookaheads in parallel threads.
+ * The winning regions found by the finished searches are merged (each is an under-approximation of the winning region).
+ * Once a search proves that the initial states are winning, no further searches are started; running searches cannot be interrupted and finish.
+ */
+template<typename ValueType>
+QualitativePortfolioResult computeWinningRegionPortfolio(SparsePomdp<ValueType> const& pomdp, storm::logic::Formula const& formula, std::vector<uint64_t> const& lookaheads,
+                                                         storm::pomdp::MemlessSearchOptions const& options, uint64_t threads) {
+    STORM_LOG_THROW(!lookaheads.empty(), storm::exceptions::InvalidArgumentException, "At least one lookahead must be given.");
+    storm::analysis::QualitativeAnalysisOnGraphs<ValueType> qualitativeAnalysis(pomdp);
+    storm::storage::BitVector targetStates = qualitativeAnalysis.analyseProb1(formula.asProbabilityOperatorFormula());
+    storm::storage::BitVector surelyNotAlmostSurelyReachTarget = qualitativeAnalysis.analyseProbSmaller1(formula.asProbabilityOperatorFormula());
+
+    QualitativePortfolioResult result;
+    for (auto const& lookahead : lookaheads) {
+        result.configurations.push_back({lookahead});
+    }
+    threads = threads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : threads;
+    threads = std::min<uint64_t>(threads, lookaheads.size());
+    std::mutex mutex;
+    std::atomic<uint64_t> next(0);
+    std::atomic<bool> proven(false);
+    std::vector<std::exception_ptr> exceptions(threads);
+    auto work = [&](uint64_t worker) {
+        try {
+            for (uint64_t index = next++; index < lookaheads.size() && !proven; index = next++) {
+                auto start = std::chrono::steady_clock::now();
+                std::shared_ptr<storm::utility::solver::SmtSolverFactory> smtSolverFactory = std::make_shared<storm::utility::solver::Z3SmtSolverFactory>();
+                storm::pomdp::IterativePolicySearch<ValueType> search(pomdp, targetStates, surelyNotAlmostSurelyReachTarget, smtSolverFactory, options);
+                bool winning = search.analyzeForInitialStates(lookaheads[index]);
+                storm::pomdp::WinningRegion const& region = search.getLastWinningRegion();
+
+                std::lock_guard<std::mutex> lock(mutex);
+                auto& configuration = result.configurations[index];
+                configuration.started = true;
+                configuration.initialStatesWinning = winning;
+                configuration.time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                if (!result.winningRegion) {
+                    result.winningRegion = region;
+                } else {
+                    for (uint64_t observation = 0; observation < region.getNumberOfObservations(); ++observation) {
+                        for (auto const& winningSet : region.getWinningSetsPerObservation(observation)) {
+                            result.winningRegion->update(observation, winningSet);
+                        }
+                    }
+                }
+                if (winning && !result.winner) {
+                    result.winner = index;
+                    result.initialStatesWinning = true;
+                    proven = true;
+                }
+            }
+        } catch (...) {
+            exceptions[worker] = std::current_exception();
+        }
+    };
+    if (threads == 1) {
+        work(0);
+    } else {
+        std::vector<std::thread> workers;
+        for (uint64_t worker = 0; worker < threads; ++worker) {
+            workers.emplace_back(work, worker);
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+    for (auto const& exception : exceptions) {
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+    }
+    return result;
+}
+
 template<typename ValueType>
 SparsePomdp<ValueType> preparePOMDPForQualitativeSearch(SparsePomdp<ValueType> const& origPomdp, storm::logic::Formula const& formula) {
     SparsePomdp<ValueType> pomdp = SparsePomdp<ValueType>(origPomdp);
@@ -38,6 +136,18 @@ void define_qualitative_policy_search(py::module& m, std::string const& vtSuffix
     mssq.def("compute_winning_region", &storm::pomdp::IterativePolicySearch<ValueType>::computeWinningRegion, py::arg("lookahead"));
     mssq.def("compute_winning_policy_for_initial_states", &storm::pomdp::IterativePolicySearch<ValueType>::analyzeForInitialStates, py::arg("lookahead"));
     mssq.def_property_readonly("last_winning_region", &storm::pomdp::IterativePolicySearch<ValueType>::getLastWinningRegion, "get the last computed winning region");
+    m.def(("compute_winning_region_portfolio_" + vtSuffix).c_str(), &computeWinningRegionPortfolio<ValueType>, py::arg("pomdp"), py::arg("formula"), py::arg("lookaheads"), py::arg("options"), py::arg("threads") = 0, py::call_guard<py::gil_scoped_release>(), R"dox(
+        Run iterative qualitative searches with several lookaheads in parallel and merge their winning regions.
+
+        Once a search proves that the initial states are winning, no further searches are started.
+
+        :param pomdp: POMDP, prepared with prepare_pomdp_for_qualitative_search
+        :param formula: Formula
+        :param lookaheads: Lookahead of each configuration
+        :param options: Options for the searches
+        :param threads: Number of threads, 0 for the number of hardware threads
+        :return: Merged winning region and the result of each configuration
+        )dox");
 
     py::class_<storm::pomdp::WinningRegionQueryInterface<ValueType>> wrqi(m, ("BeliefSupportWinningRegionQueryInterface" + vtSuffix).c_str());
     wrqi.def(py::init<SparsePomdp <ValueType> const&, storm::pomdp::WinningRegion const&>(), py::arg("pomdp"), py::arg("BeliefSupportWinningRegion"));
@@ -51,6 +161,20 @@ void define_qualitative_policy_search_nt(py::module& m) {
     py::class_<storm::pomdp::MemlessSearchOptions> mssqopts(m, "IterativeQualitativeSearchOptions", "Options for the IterativeQualitativeSearch");
     mssqopts.def(py::init<>());
 
+    py::class_<QualitativePortfolioConfigurationResult>(m, "QualitativePortfolioConfigurationResult", "Result of one configuration of the qualitative portfolio")
+        .def_readonly("lookahead", &QualitativePortfolioConfigurationResult::lookahead, "Lookahead")
+        .def_readonly("started", &QualitativePortfolioConfigurationResult::started, "Whether the configuration was run")
+        .def_readonly("initial_states_winning", &QualitativePortfolioConfigurationResult::initialStatesWinning, "Whether the configuration proved the initial states winning")
+        .def_readonly("time", &QualitativePortfolioConfigurationResult::time, "Time in seconds")
+    ;
+
+    py::class_<QualitativePortfolioResult>(m, "QualitativePortfolioResult", "Result of the qualitative portfolio")
+        .def_readonly("winning_region", &QualitativePortfolioResult::winningRegion, "Merged winning region of all finished configurations")
+        .def_readonly("initial_states_winning", &QualitativePortfolioResult::initialStatesWinning, "Whether the initial states are winning")
+        .def_readonly("winner", &QualitativePortfolioResult::winner, "Index of the configuration which proved the initial states winning, None if there is none")
+        .def_readonly("configurations", &QualitativePortfolioResult::configurations, "Results of the configurations")
+    ;
+
     py::class_<storm::pomdp::WinningRegion> winningRegion(m, "BeliefSupportWinningRegion");
     winningRegion.def_static("load_from_file", &storm::pomdp::WinningRegion::loadFromFile, py::arg("filepath"));
     winningRegion.def("store_to_file", &storm::pomdp::WinningRegion::storeToFile, py::arg("filepath"), py::arg("preamble"), py::arg("append")=false);
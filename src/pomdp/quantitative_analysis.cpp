@@ -3,6 +3,14 @@
 #include <storm/adapters/RationalFunctionAdapter.h>
 #include <storm/models/sparse/Pomdp.h>
 #include <storm-pomdp/api/verification.h>
+#include <storm/exceptions/InvalidArgumentException.h>
+#include <storm/utility/macros.h>
+
+#include <atomic>
+#include <chrono>
+#include <optional>
+#include <sstream>
+#include <thread>
 
 template<typename ValueType> using Pomdp = storm::models::sparse::Pomdp<ValueType, typename storm::models::sparse::StandardRewardModel<ValueType>>;
 template<typename ValueType> using BeliefExplorationPomdpModelChecker = typename storm::pomdp::modelchecker::BeliefExplorationPomdpModelChecker<Pomdp<ValueType>, ValueType, ValueType>;
@@ -10,10 +18,106 @@ template<typename ValueType> using BeliefExplorationPomdpModelCheckerResult = ty
 template<typename ValueType> using Options = storm::pomdp::modelchecker::BeliefExplorationPomdpModelCheckerOptions<ValueType>;
 template<typename ValueType> using additionalCutoffValueType = std::vector<std::vector<std::unordered_map<uint64_t, ValueType>>>;
 
+template<typename ValueType>
+struct InteractiveBoundsUpdate {
+    // Seconds since the start of the check
+    double time;
+    ValueType lowerBound;
+    ValueType upperBound;
+    uint64_t exploredBeliefs;
+};
+
+/*!
+ * Run the check of an interactive model checker and report the bounds while unfolding.
+ * The check runs in a separate thread which is paused regularly to obtain the current bounds.
+ * Each time the bounds improve, the callback is invoked; unfolding is terminated once the gap between the bounds
+ * is at most the target gap or the callback returns False.
+ * Unless the callback stopped unfolding, the final bounds are reported as well if they differ from the last update.
+ */
+template<typename ValueType>
+typename BeliefExplorationPomdpModelChecker<ValueType>::Result checkWithBoundsCallback(BeliefExplorationPomdpModelChecker<ValueType>& checker, storm::logic::Formula const& formula,
+                                                                                     additionalCutoffValueType<ValueType> const& cutoffValues, py::function const& callback,
+                                                                                     ValueType targetGap, double updateInterval) {
+    STORM_LOG_THROW(updateInterval > 0, storm::exceptions::InvalidArgumentException, "Update interval must be positive.");
+    auto start = std::chrono::steady_clock::now();
+    auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(updateInterval));
+    std::atomic<bool> done(false);
+    std::exception_ptr checkException;
+    std::optional<typename BeliefExplorationPomdpModelChecker<ValueType>::Result> result;
+    py::gil_scoped_release release;
+    std::thread worker([&]() {
+        try {
+            result.emplace(checker.check(formula, cutoffValues));
+        } catch (...) {
+            checkException = std::current_exception();
+        }
+        done = true;
+    });
+
+    std::exception_ptr callbackException;
+    bool stoppedByCallback = false;
+    std::optional<InteractiveBoundsUpdate<ValueType>> last;
+    while (!done) {
+        std::this_thread::sleep_for(interval);
+        if (done || !checker.isExploring()) {
+            continue;
+        }
+        checker.pauseUnfolding();
+        while (!done && !checker.isResultReady()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        if (done) {
+            break;
+        }
+        auto const& current = checker.getInteractiveResult();
+        bool stop = false;
+        if (!last || current.lowerBound > last->lowerBound || current.upperBound < last->upperBound) {
+            auto explorer = checker.getInteractiveBeliefExplorer();
+            last = InteractiveBoundsUpdate<ValueType>{std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(), current.lowerBound, current.upperBound,
+                                                      explorer ? explorer->getCurrentNumberOfMdpStates() : 0};
+            stop = last->upperBound - last->lowerBound <= targetGap;
+            py::gil_scoped_acquire acquire;
+            try {
+                py::object proceed = callback(*last);
+                stoppedByCallback = !proceed.is_none() && !proceed.cast<bool>();
+            } catch (...) {
+                callbackException = std::current_exception();
+                stoppedByCallback = true;
+            }
+            stop |= stoppedByCallback;
+        }
+        if (stop) {
+            checker.terminateUnfolding();
+            break;
+        }
+        checker.continueUnfolding();
+    }
+    worker.join();
+    if (callbackException) {
+        std::rethrow_exception(callbackException);
+    }
+    if (checkException) {
+        std::rethrow_exception(checkException);
+    }
+    if (!stoppedByCallback && (!last || result->lowerBound != last->lowerBound || result->upperBound != last->upperBound)) {
+        auto explorer = checker.getInteractiveBeliefExplorer();
+        InteractiveBoundsUpdate<ValueType> update{std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(), result->lowerBound, result->upperBound,
+                                                  explorer ? explorer->getCurrentNumberOfMdpStates() : 0};
+        py::gil_scoped_acquire acquire;
+        callback(update);
+    }
+    return *result;
+}
+
 
 template<typename ValueType>
 void define_belief_exploration(py::module& m, std::string const& vtSuffix) {
-    py::class_<BeliefExplorationPomdpModelChecker<ValueType>> belmc(m, ("BeliefExplorationModelChecker" + vtSuffix).c_str());
+    py::class_<BeliefExplorationPomdpModelChecker<ValueType>> belmc(m, ("BeliefExplorationModelChecker" + vtSuffix).c_str(), R"dox(
+
+        Model checker for POMDPs based on the exploration of the belief MDP (sequentially, in Storm).
+        For a multithreaded exploration of the belief MDP with statistics on the exploration rate, use explore_belief_mdp_parallel instead.
+        It is not selectable via BeliefExplorationModelCheckerOptions and its rate is not part of get_status.
+        )dox");
     belmc.def(py::init<std::shared_ptr<Pomdp<ValueType>>, Options<ValueType>>(), py::arg("model"), py::arg("options"));
 
     belmc.def("check", py::overload_cast<storm::logic::Formula const&,additionalCutoffValueType<ValueType> const&>(&BeliefExplorationPomdpModelChecker<ValueType>::check), py::arg("formula"), py::arg("cutoff_values"));
@@ -30,6 +134,32 @@ void define_belief_exploration(py::module& m, std::string const& vtSuffix) {
     belmc.def("get_status", &BeliefExplorationPomdpModelChecker<ValueType>::getStatus);
     belmc.def("get_interactive_belief_explorer", &BeliefExplorationPomdpModelChecker<ValueType>::getInteractiveBeliefExplorer);
     belmc.def("has_converged", &BeliefExplorationPomdpModelChecker<ValueType>::hasConverged);
+    belmc.def("check_with_bounds_callback", &checkWithBoundsCallback<ValueType>, py::arg("formula"), py::arg("cutoff_values"), py::arg("callback"), py::arg("target_gap") = storm::utility::zero<ValueType>(), py::arg("update_interval") = 0.1, R"dox(
+        Check the formula with interactive unfolding and report the bounds whenever they improve.
+
+        The checker must be created with the option interactive_unfolding. Unfolding is paused every update interval to obtain the current bounds.
+        The callback receives an InteractiveBoundsUpdate and may return False to stop unfolding.
+        Unless the callback stopped unfolding, it is also invoked with the final bounds if they differ from the last update.
+
+        :param formula: Formula
+        :param cutoff_values: Additional cutoff values
+        :param callback: Function called with the improved bounds
+        :param target_gap: Unfolding stops once the gap between lower and upper bound is at most this value
+        :param update_interval: Time in seconds between two updates
+        :return: Final result
+        )dox");
+
+    py::class_<InteractiveBoundsUpdate<ValueType>>(m, ("InteractiveBoundsUpdate" + vtSuffix).c_str(), "Bounds reported during interactive unfolding")
+        .def_readonly("time", &InteractiveBoundsUpdate<ValueType>::time, "Seconds since the start of the check")
+        .def_readonly("lower_bound", &InteractiveBoundsUpdate<ValueType>::lowerBound, "Lower bound")
+        .def_readonly("upper_bound", &InteractiveBoundsUpdate<ValueType>::upperBound, "Upper bound")
+        .def_readonly("explored_beliefs", &InteractiveBoundsUpdate<ValueType>::exploredBeliefs, "Number of states of the explored belief MDP")
+        .def("__str__", [](InteractiveBoundsUpdate<ValueType> const& update) {
+                std::stringstream stream;
+                stream << "[" << update.lowerBound << ", " << update.upperBound << "] after " << update.time << "s with " << update.exploredBeliefs << " beliefs";
+                return stream.str();
+            })
+    ;
 
     py::class_<typename storm::builder::BeliefMdpExplorer<Pomdp<ValueType>, ValueType>> belmdpexpl(m, ("BeliefMdpExplorer" + vtSuffix).c_str());
     belmdpexpl.def("set_fsc_values", &storm::builder::BeliefMdpExplorer<Pomdp<ValueType>, ValueType>::setFMSchedValueList, py::arg("value_list"));
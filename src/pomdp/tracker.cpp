@@ -1,9 +1,19 @@
 #include "tracker.h"
 #include "src/helpers.h"
+#include "observation_split.h"
 
 #include <storm/adapters/RationalFunctionAdapter.h>
 #include <storm-pomdp/generator/BeliefSupportTracker.h>
 #include <storm-pomdp/generator/NondeterministicBeliefTracker.h>
+#include <storm/exceptions/InvalidArgumentException.h>
+#include <storm/utility/constants.h>
+#include <storm/utility/macros.h>
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <numeric>
+#include <thread>
 
 
 template<typename ValueType> using SparsePomdp = storm::models::sparse::Pomdp<ValueType>;
@@ -13,6 +23,187 @@ template<typename ValueType> using NDPomdpTrackerSparse = storm::generator::Nond
 template<typename ValueType> using NDPomdpTrackerDense = storm::generator::NondeterministicBeliefTracker<ValueType, storm::generator::ObservationDenseBeliefState<ValueType>>;
 
 
+/*!
+ * Tracks the beliefs of many traces of the same POMDP.
+ * The transitions are split by the observation of the successor states once, and these slices are shared by all traces.
+ * Events (trace, action, observation) are processed in batches; the traces of a batch are distributed over multiple threads while the
+ * events of each trace are applied in their order.
+ */
+template<typename ValueType>
+class BatchedBeliefTracker {
+public:
+    BatchedBeliefTracker(SparsePomdp<ValueType> const& pomdp, uint64_t numberOfTraces) : pomdp(pomdp), transitions(pomdp), observationActions(pomdp.getNrObservations(), 0) {
+        for (uint64_t state = 0; state < pomdp.getNumberOfStates(); ++state) {
+            observationActions[pomdp.getObservation(state)] = transitions.getNumberOfActions(state);
+        }
+        ValueType initialProbability = storm::utility::one<ValueType>() / storm::utility::convertNumber<ValueType>(pomdp.getInitialStates().getNumberOfSetBits());
+        for (auto const& state : pomdp.getInitialStates()) {
+            initialBelief.emplace_back(state, initialProbability);
+        }
+        addTraces(numberOfTraces);
+    }
+
+    // Returns the id of the first new trace
+    uint64_t addTraces(uint64_t count) {
+        uint64_t first = beliefs.size();
+        beliefs.resize(first + count, initialBelief);
+        return first;
+    }
+
+    void reset(uint64_t trace) {
+        checkTrace(trace);
+        beliefs[trace] = initialBelief;
+    }
+
+    /*!
+     * Track a batch of events. Event i consists of traces[i], actions[i] (local action index) and observations[i].
+     * A trace whose belief becomes empty (the observation is impossible) is invalid until it is reset.
+     * All actions are validated before any belief is updated, such that an invalid action leaves all beliefs unchanged.
+     * The first action of a trace is checked against the states of its current belief, later actions against the observation of the preceding event.
+     */
+    void track(std::vector<uint64_t> const& traces, std::vector<uint64_t> const& actions, std::vector<uint32_t> const& observations, uint64_t threads) {
+        STORM_LOG_THROW(traces.size() == actions.size() && traces.size() == observations.size(), storm::exceptions::InvalidArgumentException,
+                        "Number of traces, actions and observations must coincide.");
+        for (auto const& trace : traces) {
+            checkTrace(trace);
+        }
+        // Group the events by trace, keeping the order of the events of each trace
+        std::vector<uint64_t> order(traces.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&traces](uint64_t first, uint64_t second) { return traces[first] < traces[second]; });
+        std::vector<uint64_t> groups;
+        for (uint64_t i = 0; i < order.size(); ++i) {
+            if (i == 0 || traces[order[i]] != traces[order[i - 1]]) {
+                groups.push_back(i);
+            }
+        }
+        groups.push_back(order.size());
+        for (uint64_t group = 0; group + 1 < groups.size(); ++group) {
+            uint64_t trace = traces[order[groups[group]]];
+            for (uint64_t i = groups[group]; i < groups[group + 1]; ++i) {
+                uint64_t action = actions[order[i]];
+                if (i == groups[group]) {
+                    for (auto const& entry : beliefs[trace]) {
+                        STORM_LOG_THROW(action < transitions.getNumberOfActions(entry.first), storm::exceptions::InvalidArgumentException,
+                                        "Action " << action << " of trace " << trace << " is not available in state " << entry.first << ". No belief was updated.");
+                    }
+                } else {
+                    uint32_t observation = observations[order[i - 1]];
+                    STORM_LOG_THROW(observation >= observationActions.size() || action < observationActions[observation], storm::exceptions::InvalidArgumentException,
+                                    "Action " << action << " of trace " << trace << " is not available after observation " << observation << ". No belief was updated.");
+                }
+            }
+        }
+
+        threads = threads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : threads;
+        threads = std::max<uint64_t>(1, std::min<uint64_t>(threads, groups.size() - 1));
+        std::atomic<uint64_t> next(0);
+        std::vector<std::exception_ptr> exceptions(threads);
+        auto work = [&](uint64_t worker) {
+            try {
+                // Dense scratch space for the successor belief
+                std::vector<ValueType> values(pomdp.getNumberOfStates(), storm::utility::zero<ValueType>());
+                std::vector<char> touched(pomdp.getNumberOfStates(), 0);
+                std::vector<uint64_t> touchedStates;
+                for (uint64_t group = next++; group + 1 < groups.size(); group = next++) {
+                    for (uint64_t i = groups[group]; i < groups[group + 1]; ++i) {
+                        uint64_t event = order[i];
+                        update(beliefs[traces[event]], actions[event], observations[event], values, touched, touchedStates);
+                    }
+                }
+            } catch (...) {
+                exceptions[worker] = std::current_exception();
+            }
+        };
+        if (threads == 1) {
+            work(0);
+        } else {
+            std::vector<std::thread> workers;
+            for (uint64_t worker = 0; worker < threads; ++worker) {
+                workers.emplace_back(work, worker);
+            }
+            for (auto& worker : workers) {
+                worker.join();
+            }
+        }
+        for (auto const& exception : exceptions) {
+            if (exception) {
+                std::rethrow_exception(exception);
+            }
+        }
+    }
+
+    std::map<uint64_t, ValueType> getBelief(uint64_t trace) const {
+        checkTrace(trace);
+        return std::map<uint64_t, ValueType>(beliefs[trace].begin(), beliefs[trace].end());
+    }
+
+    storm::storage::BitVector getBeliefSupport(uint64_t trace) const {
+        checkTrace(trace);
+        storm::storage::BitVector support(pomdp.getNumberOfStates());
+        for (auto const& entry : beliefs[trace]) {
+            support.set(entry.first);
+        }
+        return support;
+    }
+
+    bool isValid(uint64_t trace) const {
+        checkTrace(trace);
+        return !beliefs[trace].empty();
+    }
+
+    uint64_t getNumberOfTraces() const {
+        return beliefs.size();
+    }
+
+private:
+    void checkTrace(uint64_t trace) const {
+        STORM_LOG_THROW(trace < beliefs.size(), storm::exceptions::InvalidArgumentException, "Trace " << trace << " does not exist.");
+    }
+
+    void update(std::vector<std::pair<uint64_t, ValueType>>& belief, uint64_t action, uint32_t observation, std::vector<ValueType>& values, std::vector<char>& touched,
+                std::vector<uint64_t>& touchedStates) const {
+        if (belief.empty()) {
+            return;
+        }
+        ValueType sum = storm::utility::zero<ValueType>();
+        for (auto const& [state, probability] : belief) {
+            STORM_LOG_ASSERT(action < transitions.getNumberOfActions(state), "Action " << action << " is not available in state " << state << ".");
+            uint64_t slice = transitions.findSlice(transitions.getRow(state, action), observation);
+            if (slice == transitions.getNumberOfSlices()) {
+                continue;
+            }
+            for (uint64_t entry = transitions.sliceEntryOffsets[slice]; entry < transitions.sliceEntryOffsets[slice + 1]; ++entry) {
+                uint64_t successor = transitions.columns[entry];
+                ValueType value = probability * transitions.values[entry];
+                if (!touched[successor]) {
+                    touched[successor] = 1;
+                    touchedStates.push_back(successor);
+                }
+                values[successor] += value;
+                sum += value;
+            }
+        }
+        std::sort(touchedStates.begin(), touchedStates.end());
+        belief.clear();
+        for (auto const& state : touchedStates) {
+            if (!storm::utility::isZero(values[state])) {
+                belief.emplace_back(state, values[state] / sum);
+            }
+            values[state] = storm::utility::zero<ValueType>();
+            touched[state] = 0;
+        }
+        touchedStates.clear();
+    }
+
+    SparsePomdp<ValueType> const& pomdp;
+    ObservationSplitTransitions<ValueType> transitions;
+    // Number of actions of the states with each observation
+    std::vector<uint64_t> observationActions;
+    std::vector<std::pair<uint64_t, ValueType>> initialBelief;
+    std::vector<std::vector<std::pair<uint64_t, ValueType>>> beliefs;
+};
+
 template<typename ValueType>
 void define_tracker(py::module& m, std::string const& vtSuffix) {
     py::class_<storm::generator::BeliefSupportTracker<ValueType>> tracker(m, ("BeliefSupportTracker" + vtSuffix).c_str(), "Tracker for BeliefSupports");
@@ -50,6 +241,25 @@ void define_tracker(py::module& m, std::string const& vtSuffix) {
     ndetbelieftracker.def("reduce",&NDPomdpTrackerSparse<ValueType>::reduce);
     ndetbelieftracker.def("reduction_timed_out", &NDPomdpTrackerSparse<ValueType>::hasTimedOut);
 
+    py::class_<BatchedBeliefTracker<ValueType>> batchedtracker(m, ("BatchedBeliefTracker" + vtSuffix).c_str(), "Tracker for the beliefs of many traces of the same POMDP");
+    batchedtracker.def(py::init<SparsePomdp<ValueType> const&, uint64_t>(), py::arg("pomdp"), py::arg("nr_traces") = 0, py::keep_alive<1, 2>());
+    batchedtracker.def("add_traces", &BatchedBeliefTracker<ValueType>::addTraces, py::arg("count"), "Add traces starting in the initial belief, returns the id of the first new trace");
+    batchedtracker.def("reset", &BatchedBeliefTracker<ValueType>::reset, py::arg("trace"), "Reset the trace to the initial belief");
+    batchedtracker.def("track", &BatchedBeliefTracker<ValueType>::track, py::arg("traces"), py::arg("actions"), py::arg("observations"), py::arg("threads") = 0, py::call_guard<py::gil_scoped_release>(), R"dox(
+        Track a batch of events, event i consists of traces[i], actions[i] and observations[i].
+
+        Events of the same trace are applied in their order. A trace becomes invalid if the observation is impossible.
+
+        :param traces: Trace ids
+        :param actions: Local action indices
+        :param observations: Observations
+        :param threads: Number of threads, 0 for the number of hardware threads
+        )dox");
+    batchedtracker.def("get_belief", &BatchedBeliefTracker<ValueType>::getBelief, py::arg("trace"), "Get the current belief of the trace");
+    batchedtracker.def("get_belief_support", &BatchedBeliefTracker<ValueType>::getBeliefSupport, py::arg("trace"), "Get the support of the current belief of the trace");
+    batchedtracker.def("is_valid", &BatchedBeliefTracker<ValueType>::isValid, py::arg("trace"), "Is the trace consistent with the POMDP");
+    batchedtracker.def_property_readonly("nr_traces", &BatchedBeliefTracker<ValueType>::getNumberOfTraces);
+
 //    py::class_<NDPomdpTrackerDense<double>> ndetbelieftrackerd(m, "NondeterministicBeliefTrackerDoubleDense", "Tracker for belief states and uncontrollable actions");
 //    ndetbelieftrackerd.def(py::init<SparsePomdp<double> const&>(), py::arg("pomdp"));
 //    ndetbelieftrackerd.def("reset", &NDPomdpTrackerDense<double>::reset);
@@ -1,4 +1,5 @@
 #include "transformations.h"
+#include "observation_split.h"
 #include <storm-pomdp/transformer/MakePOMDPCanonic.h>
 #include <storm-pomdp/transformer/PomdpMemoryUnfolder.h>
 #include <storm-pomdp/transformer/BinaryPomdpTransformer.h>
@@ -6,6 +7,20 @@
 #include <storm-pomdp/transformer/ObservationTraceUnfolder.h>
 #include <storm/adapters/RationalFunctionAdapter.h>
 #include <storm/storage/expressions/ExpressionManager.h>
+#include <storm/storage/sparse/ModelComponents.h>
+#include <storm/models/sparse/StandardRewardModel.h>
+#include <storm/exceptions/InvalidArgumentException.h>
+#include <storm/utility/macros.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
 
 template<typename ValueType>
 std::shared_ptr<storm::models::sparse::Pomdp<ValueType>> make_canonic(storm::models::sparse::Pomdp<ValueType> const& pomdp) {
@@ -37,6 +52,372 @@ std::shared_ptr<storm::models::sparse::Mdp<ValueType>> unfold_trace(storm::model
     return transformer.transform(observationTrace, riskDef);
 }
 
+struct ReachableMemoryProduct {
+    std::shared_ptr<storm::models::sparse::Pomdp<double>> pomdp;
+    // POMDP state and memory state of each product state
+    std::vector<uint64_t> stateOrigins;
+    std::vector<uint64_t> memoryOrigins;
+    uint64_t fullProductStates = 0;
+    uint64_t threads = 0;
+    double constructionTime = 0;
+
+    double getSizeReduction() const {
+        return fullProductStates > 0 ? 1.0 - static_cast<double>(stateOrigins.size()) / fullProductStates : 0;
+    }
+};
+
+/*!
+ * Product of a POMDP with a memory structure which only contains the reachable product states.
+ * The product is explored level by level with multiple threads, product states are looked up in a sharded hash table.
+ * As in the PomdpMemoryUnfolder, the choices of a product state (s, m) are pairs of an action of s and a memory successor of m,
+ * and the observation of (s, m) is the observation of s combined with m.
+ */
+class ReachableMemoryProductBuilder {
+public:
+    ReachableMemoryProductBuilder(storm::models::sparse::Pomdp<double> const& pomdp, storm::storage::PomdpMemory const& memory, bool addMemoryLabels, uint64_t threads)
+        : pomdp(pomdp), memory(memory), addMemoryLabels(addMemoryLabels) {
+        STORM_LOG_THROW(!pomdp.hasRewardModel() || std::none_of(pomdp.getRewardModels().begin(), pomdp.getRewardModels().end(), [](auto const& rewardModel) { return rewardModel.second.hasTransitionRewards(); }),
+                        storm::exceptions::InvalidArgumentException, "Transition rewards are not supported.");
+        this->threads = threads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : threads;
+    }
+
+    ReachableMemoryProduct build() {
+        auto start = std::chrono::steady_clock::now();
+        ReachableMemoryProduct result;
+        result.threads = threads;
+        result.fullProductStates = pomdp.getNumberOfStates() * memory.getNumberOfStates();
+        for (auto const& state : pomdp.getInitialStates()) {
+            uint64_t id = insert(state * memory.getNumberOfStates() + memory.getInitialState()).first;
+            result.stateOrigins.push_back(state);
+            result.memoryOrigins.push_back(memory.getInitialState());
+            initialStates.push_back(id);
+        }
+        std::vector<uint64_t> frontier = initialStates;
+        while (!frontier.empty()) {
+            rows.resize(counter);
+            std::vector<std::vector<uint64_t>> discovered(threads);
+            std::atomic<uint64_t> next(0);
+            auto work = [&](uint64_t worker) {
+                for (uint64_t index = next++; index < frontier.size(); index = next++) {
+                    uint64_t id = frontier[index];
+                    expand(id, result.stateOrigins[id], result.memoryOrigins[id], discovered[worker]);
+                }
+            };
+            if (threads == 1) {
+                work(0);
+            } else {
+                std::vector<std::thread> workers;
+                for (uint64_t worker = 0; worker < threads; ++worker) {
+                    workers.emplace_back(work, worker);
+                }
+                for (auto& worker : workers) {
+                    worker.join();
+                }
+            }
+            frontier.clear();
+            for (auto const& newStates : discovered) {
+                frontier.insert(frontier.end(), newStates.begin(), newStates.end());
+            }
+            std::sort(frontier.begin(), frontier.end());
+            result.stateOrigins.resize(counter);
+            result.memoryOrigins.resize(counter);
+            for (auto const& id : frontier) {
+                result.stateOrigins[id] = keys[id] / memory.getNumberOfStates();
+                result.memoryOrigins[id] = keys[id] % memory.getNumberOfStates();
+            }
+        }
+        result.pomdp = buildPomdp(result.stateOrigins, result.memoryOrigins);
+        result.constructionTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return result;
+    }
+
+private:
+    // Choice of a product state: the original row and the successors (product state id and probability)
+    struct ProductRow {
+        uint64_t origin;
+        std::vector<std::pair<uint64_t, double>> successors;
+    };
+
+    // Returns the id of the product state (state * nrMemoryStates + memory) and whether it was inserted
+    std::pair<uint64_t, bool> insert(uint64_t key) {
+        Shard& shard = shards[key % shardCount];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.ids.find(key);
+        if (it != shard.ids.end()) {
+            return {it->second, false};
+        }
+        uint64_t id = counter++;
+        shard.ids.emplace(key, id);
+        std::lock_guard<std::mutex> keyLock(keyMutex);
+        if (keys.size() <= id) {
+            keys.resize(id + 1);
+        }
+        keys[id] = key;
+        return {id, true};
+    }
+
+    void expand(uint64_t id, uint64_t state, uint64_t memoryState, std::vector<uint64_t>& discovered) {
+        auto const& matrix = pomdp.getTransitionMatrix();
+        std::vector<ProductRow> productRows;
+        for (uint64_t row = matrix.getRowGroupIndices()[state]; row < matrix.getRowGroupIndices()[state + 1]; ++row) {
+            for (auto const& memorySuccessor : memory.getTransitions(memoryState)) {
+                ProductRow productRow{row, {}};
+                for (auto const& entry : matrix.getRow(row)) {
+                    auto [successor, inserted] = insert(entry.getColumn() * memory.getNumberOfStates() + memorySuccessor);
+                    if (inserted) {
+                        discovered.push_back(successor);
+                    }
+                    productRow.successors.emplace_back(successor, entry.getValue());
+                }
+                std::sort(productRow.successors.begin(), productRow.successors.end());
+                productRows.push_back(std::move(productRow));
+            }
+        }
+        rows[id] = std::move(productRows);
+    }
+
+    std::shared_ptr<storm::models::sparse::Pomdp<double>> buildPomdp(std::vector<uint64_t> const& stateOrigins, std::vector<uint64_t> const& memoryOrigins) const {
+        uint64_t stateCount = stateOrigins.size();
+        storm::storage::SparseMatrixBuilder<double> builder(0, stateCount, 0, false, true, stateCount);
+        std::vector<uint64_t> choiceOrigins;
+        uint64_t row = 0;
+        for (uint64_t id = 0; id < stateCount; ++id) {
+            builder.newRowGroup(row);
+            for (auto const& productRow : rows[id]) {
+                for (auto const& [successor, probability] : productRow.successors) {
+                    builder.addNextValue(row, successor, probability);
+                }
+                choiceOrigins.push_back(productRow.origin);
+                ++row;
+            }
+        }
+
+        storm::models::sparse::StateLabeling labeling(stateCount);
+        for (auto const& label : pomdp.getStateLabeling().getLabels()) {
+            storm::storage::BitVector const& labelStates = pomdp.getStateLabeling().getStates(label);
+            storm::storage::BitVector productStates(stateCount);
+            for (uint64_t id = 0; id < stateCount; ++id) {
+                productStates.set(id, labelStates.get(stateOrigins[id]) && (label != "init" || memoryOrigins[id] == memory.getInitialState()));
+            }
+            labeling.addLabel(label, std::move(productStates));
+        }
+        if (addMemoryLabels) {
+            for (uint64_t memoryState = 0; memoryState < memory.getNumberOfStates(); ++memoryState) {
+                storm::storage::BitVector productStates(stateCount);
+                for (uint64_t id = 0; id < stateCount; ++id) {
+                    productStates.set(id, memoryOrigins[id] == memoryState);
+                }
+                labeling.addLabel("memstate_" + std::to_string(memoryState), std::move(productStates));
+            }
+        }
+
+        std::unordered_map<std::string, storm::models::sparse::StandardRewardModel<double>> rewardModels;
+        for (auto const& [name, rewardModel] : pomdp.getRewardModels()) {
+            std::optional<std::vector<double>> stateRewards;
+            std::optional<std::vector<double>> actionRewards;
+            if (rewardModel.hasStateRewards()) {
+                stateRewards = std::vector<double>(stateCount);
+                for (uint64_t id = 0; id < stateCount; ++id) {
+                    (*stateRewards)[id] = rewardModel.getStateReward(stateOrigins[id]);
+                }
+            }
+            if (rewardModel.hasStateActionRewards()) {
+                actionRewards = std::vector<double>(choiceOrigins.size());
+                for (uint64_t choice = 0; choice < choiceOrigins.size(); ++choice) {
+                    (*actionRewards)[choice] = rewardModel.getStateActionReward(choiceOrigins[choice]);
+                }
+            }
+            rewardModels.emplace(name, storm::models::sparse::StandardRewardModel<double>(std::move(stateRewards), std::move(actionRewards)));
+        }
+
+        storm::storage::sparse::ModelComponents<double> components(builder.build(row, stateCount, stateCount), std::move(labeling), std::move(rewardModels));
+        std::vector<uint32_t> observations(stateCount);
+        for (uint64_t id = 0; id < stateCount; ++id) {
+            observations[id] = pomdp.getObservation(stateOrigins[id]) * memory.getNumberOfStates() + memoryOrigins[id];
+        }
+        components.observabilityClasses = std::move(observations);
+        return std::make_shared<storm::models::sparse::Pomdp<double>>(std::move(components), pomdp.isCanonic());
+    }
+
+    static constexpr std::size_t shardCount = 64;
+
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<uint64_t, uint64_t> ids;
+    };
+
+    storm::models::sparse::Pomdp<double> const& pomdp;
+    storm::storage::PomdpMemory const& memory;
+    bool addMemoryLabels;
+    uint64_t threads;
+    std::array<Shard, shardCount> shards;
+    std::atomic<uint64_t> counter{0};
+    // Key of each product state
+    std::vector<uint64_t> keys;
+    std::mutex keyMutex;
+    std::vector<uint64_t> initialStates;
+    std::vector<std::vector<ProductRow>> rows;
+};
+
+/*!
+ * Incremental monitoring of the risk of an observation trace.
+ * Instead of building and checking the unfolding of the whole trace, only the last layer of the unfolding is kept:
+ * for each state consistent with the trace, a lower and upper bound on the probability to reach it while observing the trace.
+ * Extending the trace computes the next layer from the current one, thus the time per observation is proportional to the size of the layer.
+ * Each state of the layer contributes its bounds times the minimal and maximal probability over its actions to move to a successor.
+ * As the action is chosen separately for each state, the bounds hold for every scheduler of the unfolding of the trace, including
+ * schedulers which are not observation-based, e.g., the schedulers considered by Pmax on the result of ObservationTraceUnfolder.
+ * The risk (conditional probability of the risk given the trace) is enclosed by bounds computed from the layer, which coincide if every state has only one action.
+ * Otherwise, the bounds are not tight and the gap can grow with the length of the trace.
+ * Probabilities of each layer are normalized as only their ratios matter.
+ */
+class IncrementalObservationTraceUnfolder {
+public:
+    IncrementalObservationTraceUnfolder(storm::models::sparse::Pomdp<double> const& pomdp, std::vector<double> const& risk) : pomdp(pomdp), transitions(pomdp), risk(risk) {
+        STORM_LOG_THROW(risk.size() == pomdp.getNumberOfStates(), storm::exceptions::InvalidArgumentException, "Risk must be given for each state.");
+        maxValues.resize(pomdp.getNumberOfStates(), 0);
+        minValues.resize(pomdp.getNumberOfStates(), 0);
+        counts.resize(pomdp.getNumberOfStates(), 0);
+        lowerAccumulated.resize(pomdp.getNumberOfStates(), 0);
+        upperAccumulated.resize(pomdp.getNumberOfStates(), 0);
+        touched.resize(pomdp.getNumberOfStates(), 0);
+    }
+
+    // Start a new trace with the observation of the initial state
+    std::pair<double, double> reset(uint32_t observation) {
+        auto start = std::chrono::steady_clock::now();
+        trace = {observation};
+        latencies.clear();
+        states.clear();
+        lower.clear();
+        upper.clear();
+        for (auto const& state : pomdp.getInitialStates()) {
+            if (pomdp.getObservation(state) == observation) {
+                states.push_back(state);
+                lower.push_back(1);
+                upper.push_back(1);
+            }
+        }
+        latencies.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        return getRiskBounds();
+    }
+
+    // Extend the trace by the observation and return the bounds on the risk
+    std::pair<double, double> extend(uint32_t observation) {
+        STORM_LOG_THROW(!trace.empty(), storm::exceptions::InvalidArgumentException, "The trace must be started with reset.");
+        auto start = std::chrono::steady_clock::now();
+        trace.push_back(observation);
+        std::vector<uint64_t> successors;
+        for (uint64_t i = 0; i < states.size(); ++i) {
+            uint64_t actions = transitions.getNumberOfActions(states[i]);
+            // Minimal and maximal probability over the actions to move to a successor with the observation
+            std::vector<uint64_t> localSuccessors;
+            for (uint64_t action = 0; action < actions; ++action) {
+                uint64_t slice = transitions.findSlice(transitions.getRow(states[i], action), observation);
+                if (slice == transitions.getNumberOfSlices()) {
+                    continue;
+                }
+                for (uint64_t entry = transitions.sliceEntryOffsets[slice]; entry < transitions.sliceEntryOffsets[slice + 1]; ++entry) {
+                    uint64_t successor = transitions.columns[entry];
+                    double probability = transitions.values[entry];
+                    if (counts[successor] == 0) {
+                        localSuccessors.push_back(successor);
+                        maxValues[successor] = probability;
+                        minValues[successor] = probability;
+                    } else {
+                        maxValues[successor] = std::max(maxValues[successor], probability);
+                        minValues[successor] = std::min(minValues[successor], probability);
+                    }
+                    ++counts[successor];
+                }
+            }
+            for (auto const& successor : localSuccessors) {
+                if (!touched[successor]) {
+                    touched[successor] = 1;
+                    successors.push_back(successor);
+                }
+                upperAccumulated[successor] += upper[i] * maxValues[successor];
+                // Actions which do not lead to the successor have probability zero
+                if (counts[successor] == actions) {
+                    lowerAccumulated[successor] += lower[i] * minValues[successor];
+                }
+                counts[successor] = 0;
+            }
+        }
+
+        std::sort(successors.begin(), successors.end());
+        states.clear();
+        lower.clear();
+        upper.clear();
+        double scale = 0;
+        for (auto const& successor : successors) {
+            scale = std::max(scale, upperAccumulated[successor]);
+        }
+        for (auto const& successor : successors) {
+            if (upperAccumulated[successor] > 0) {
+                states.push_back(successor);
+                lower.push_back(lowerAccumulated[successor] / scale);
+                upper.push_back(upperAccumulated[successor] / scale);
+            }
+            lowerAccumulated[successor] = 0;
+            upperAccumulated[successor] = 0;
+            touched[successor] = 0;
+        }
+        latencies.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        return getRiskBounds();
+    }
+
+    // Lower and upper bound on the risk, NaN if the trace is impossible
+    std::pair<double, double> getRiskBounds() const {
+        if (states.empty()) {
+            return {std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::quiet_NaN()};
+        }
+        double lowerRisk = 0, upperRisk = 0, lowerSafe = 0, upperSafe = 0;
+        for (uint64_t i = 0; i < states.size(); ++i) {
+            lowerRisk += lower[i] * risk[states[i]];
+            upperRisk += upper[i] * risk[states[i]];
+            lowerSafe += lower[i] * (1 - risk[states[i]]);
+            upperSafe += upper[i] * (1 - risk[states[i]]);
+        }
+        return {upperSafe == 0 ? 1 : lowerRisk / (lowerRisk + upperSafe), upperRisk == 0 ? 0 : upperRisk / (upperRisk + lowerSafe)};
+    }
+
+    bool isConsistent() const {
+        return !states.empty();
+    }
+
+    std::vector<uint32_t> const& getTrace() const {
+        return trace;
+    }
+
+    std::vector<uint64_t> const& getLayerStates() const {
+        return states;
+    }
+
+    std::vector<double> const& getLatencies() const {
+        return latencies;
+    }
+
+private:
+    storm::models::sparse::Pomdp<double> const& pomdp;
+    ObservationSplitTransitions<double> transitions;
+    std::vector<double> risk;
+    std::vector<uint32_t> trace;
+    // Last layer of the unfolding: states and their minimal and maximal (normalized) probability
+    std::vector<uint64_t> states;
+    std::vector<double> lower;
+    std::vector<double> upper;
+    // Seconds needed for each observation
+    std::vector<double> latencies;
+    // Scratch space indexed by states
+    std::vector<double> maxValues;
+    std::vector<double> minValues;
+    std::vector<uint64_t> counts;
+    std::vector<double> lowerAccumulated;
+    std::vector<double> upperAccumulated;
+    std::vector<char> touched;
+};
+
 // STANDARD, SIMPLE_LINEAR, SIMPLE_LINEAR_INVERSE, SIMPLE_LOG, FULL
 void define_transformations_nt(py::module &m) {
     py::enum_<storm::transformer::PomdpFscApplicationMode>(m, "PomdpFscApplicationMode")
@@ -47,6 +428,38 @@ void define_transformations_nt(py::module &m) {
             .value("full", storm::transformer::PomdpFscApplicationMode::FULL)
             ;
 
+    py::class_<ReachableMemoryProduct>(m, "ReachableMemoryProduct", "Product of a POMDP with a memory structure restricted to the reachable states")
+        .def_readonly("pomdp", &ReachableMemoryProduct::pomdp, "Product POMDP")
+        .def_readonly("state_origins", &ReachableMemoryProduct::stateOrigins, "POMDP state of each product state")
+        .def_readonly("memory_origins", &ReachableMemoryProduct::memoryOrigins, "Memory state of each product state")
+        .def_readonly("full_product_states", &ReachableMemoryProduct::fullProductStates, "Number of states of the full product")
+        .def_readonly("threads", &ReachableMemoryProduct::threads, "Number of threads")
+        .def_readonly("construction_time", &ReachableMemoryProduct::constructionTime, "Construction time in seconds")
+        .def_property_readonly("size_reduction", &ReachableMemoryProduct::getSizeReduction, "Fraction of the states of the full product which are unreachable")
+    ;
+
+    m.def("_unfold_memory_reachable_Double", [](storm::models::sparse::Pomdp<double> const& pomdp, storm::storage::PomdpMemory const& memory, bool addMemoryLabels, uint64_t threads) {
+            return ReachableMemoryProductBuilder(pomdp, memory, addMemoryLabels, threads).build();
+        }, "Unfold memory into a POMDP, only building the reachable product", py::arg("pomdp"), py::arg("memorystructure"), py::arg("memorylabels") = false, py::arg("threads") = 0, py::call_guard<py::gil_scoped_release>());
+
+    py::class_<IncrementalObservationTraceUnfolder>(m, "IncrementalObservationTraceUnfolder", R"dox(
+        Incremental risk monitoring for observation traces which only keeps the last layer of the unfolding.
+
+        Each observation is processed in time proportional to the states consistent with the trace.
+        The risk is returned as lower and upper bound, which coincide if every state has only one action.
+        With several actions, the bounds enclose the risk under every scheduler of the unfolding (not only observation-based ones),
+        but are not tight and may diverge for long traces.
+        )dox")
+        .def(py::init<storm::models::sparse::Pomdp<double> const&, std::vector<double> const&>(), py::arg("model"), py::arg("risk"), py::keep_alive<1, 2>())
+        .def("reset", &IncrementalObservationTraceUnfolder::reset, py::arg("new_observation"), "Start a new trace with the observation, returns the bounds on the risk")
+        .def("extend", &IncrementalObservationTraceUnfolder::extend, py::arg("new_observation"), "Extend the trace by the observation, returns the bounds on the risk")
+        .def_property_readonly("risk_bounds", &IncrementalObservationTraceUnfolder::getRiskBounds, "Lower and upper bound on the risk, NaN if the trace is impossible")
+        .def_property_readonly("is_consistent", &IncrementalObservationTraceUnfolder::isConsistent, "Is the trace possible")
+        .def_property_readonly("trace", &IncrementalObservationTraceUnfolder::getTrace, "Observation trace")
+        .def_property_readonly("layer_states", &IncrementalObservationTraceUnfolder::getLayerStates, "States consistent with the trace")
+        .def_property_readonly("latencies", &IncrementalObservationTraceUnfolder::getLatencies, "Time in seconds needed for each observation")
+    ;
+
 }
 
 template<typename ValueType>
@@ -1,11 +1,86 @@
 #include "decomposition.h"
+#include "src/numpy_helpers.h"
 
+#include "storm/models/sparse/Model.h"
 #include "storm/storage/MaximalEndComponent.h"
 #include "storm/storage/MaximalEndComponentDecomposition.h"
+#include "storm/storage/StronglyConnectedComponent.h"
+#include "storm/storage/StronglyConnectedComponentDecomposition.h"
+
+#include <algorithm>
 
 
 using MEC = storm::storage::MaximalEndComponent;
 template<typename ValueType> using MECDecomposition = storm::storage::MaximalEndComponentDecomposition<ValueType>;
+using SCC = storm::storage::StronglyConnectedComponent;
+template<typename ValueType> using SCCDecomposition = storm::storage::StronglyConnectedComponentDecomposition<ValueType>;
+
+// Decomposition in compressed sparse row format.
+// The states of component i are states[offsets[i]:offsets[i+1]], its choices are choices[choiceOffsets[i]:choiceOffsets[i+1]].
+struct FlatDecomposition {
+    std::vector<uint64_t> offsets = {0};
+    std::vector<uint64_t> states;
+    std::vector<uint64_t> choiceOffsets = {0};
+    std::vector<uint64_t> choices;
+
+    uint64_t size() const {
+        return offsets.size() - 1;
+    }
+};
+
+template<typename ValueType>
+FlatDecomposition flattenDecomposition(MECDecomposition<ValueType> const& decomposition) {
+    FlatDecomposition result;
+    for (auto const& mec : decomposition) {
+        uint64_t firstState = result.states.size();
+        for (auto const& stateChoices : mec) {
+            result.states.push_back(stateChoices.first);
+        }
+        std::sort(result.states.begin() + firstState, result.states.end());
+        for (uint64_t i = firstState; i < result.states.size(); ++i) {
+            auto const& choices = mec.getChoicesForState(result.states[i]);
+            result.choices.insert(result.choices.end(), choices.begin(), choices.end());
+        }
+        result.offsets.push_back(result.states.size());
+        result.choiceOffsets.push_back(result.choices.size());
+    }
+    return result;
+}
+
+template<typename ValueType>
+FlatDecomposition flattenDecomposition(SCCDecomposition<ValueType> const& decomposition) {
+    FlatDecomposition result;
+    for (auto const& scc : decomposition) {
+        // States in a block are sorted
+        result.states.insert(result.states.end(), scc.begin(), scc.end());
+        result.offsets.push_back(result.states.size());
+        result.choiceOffsets.push_back(0);
+    }
+    return result;
+}
+
+void define_flat_decomposition(py::module& m) {
+    py::class_<FlatDecomposition, std::shared_ptr<FlatDecomposition>>(m, "FlatDecomposition", R"dox(
+
+        Decomposition in compressed sparse row format.
+        The states of component i are states[offsets[i]:offsets[i+1]] and its choices are choices[choice_offsets[i]:choice_offsets[i+1]].
+        States and choices are sorted within each component.
+        )dox")
+        .def_property_readonly("nr_components", &FlatDecomposition::size, "Number of components")
+        .def_property_readonly("offsets", [](py::object const& self) {
+                return vectorAsNumpy(self.cast<FlatDecomposition const&>().offsets, self);
+            }, "Start of each component in states (with an additional entry for the end)")
+        .def_property_readonly("states", [](py::object const& self) {
+                return vectorAsNumpy(self.cast<FlatDecomposition const&>().states, self);
+            }, "States of all components")
+        .def_property_readonly("choice_offsets", [](py::object const& self) {
+                return vectorAsNumpy(self.cast<FlatDecomposition const&>().choiceOffsets, self);
+            }, "Start of each component in choices (with an additional entry for the end)")
+        .def_property_readonly("choices", [](py::object const& self) {
+                return vectorAsNumpy(self.cast<FlatDecomposition const&>().choices, self);
+            }, "Choices of all components. Empty for SCC decompositions.")
+    ;
+}
 
 
 void define_maximal_end_components(py::module& m) {
@@ -29,6 +104,48 @@ void define_maximal_end_component_decomposition(py::module& m, std::string const
         .def("__iter__", [](MECDecomposition<ValueType> const& mecs) {
                 return py::make_iterator(mecs.begin(), mecs.end());
             }, py::keep_alive<0, 1>() /* Essential: keep object alive while iterator exists */)
+        .def("flatten", [](MECDecomposition<ValueType> const& mecs) {
+                return flattenDecomposition(mecs);
+            }, py::call_guard<py::gil_scoped_release>(), "Export the decomposition as flat arrays of states and choices")
+    ;
+
+}
+
+void define_strongly_connected_components(py::module& m) {
+
+    py::class_<SCC, std::shared_ptr<SCC>>(m, "StronglyConnectedComponent", "Strongly connected component")
+        .def_property_readonly("size", &SCC::size, "Number of states in SCC")
+        .def_property_readonly("is_trivial", &SCC::isTrivial, "Flag whether the SCC consists of a single state without self-loop")
+        .def("__iter__", [](SCC const& scc) {
+                return py::make_iterator(scc.begin(), scc.end());
+            }, py::keep_alive<0, 1>() /* Essential: keep object alive while iterator exists */)
+    ;
+
+}
+
+template<typename ValueType>
+void define_strongly_connected_component_decomposition(py::module& m, std::string const& vt_suffix) {
+
+    py::class_<SCCDecomposition<ValueType>, std::shared_ptr<SCCDecomposition<ValueType>>>(m, ("StronglyConnectedComponentDecomposition"+vt_suffix).c_str(), "Decomposition of strongly connected components")
+        .def(py::init([](storm::models::sparse::Model<ValueType> const& model, bool dropNaiveSccs, bool onlyBottomSccs) {
+                storm::storage::StronglyConnectedComponentDecompositionOptions options;
+                options.dropNaiveSccs(dropNaiveSccs).onlyBottomSccs(onlyBottomSccs);
+                return SCCDecomposition<ValueType>(model.getTransitionMatrix(), options);
+            }), py::arg("model"), py::arg("drop_naive_sccs") = false, py::arg("only_bottom_sccs") = false, R"dox(
+
+            Create SCCs from model.
+
+            :param model: The model
+            :param bool drop_naive_sccs: Flag whether trivial SCCs (single states without self-loop) are omitted
+            :param bool only_bottom_sccs: Flag whether only bottom SCCs (SCCs without outgoing transitions) are computed
+            )dox")
+        .def_property_readonly("size", &SCCDecomposition<ValueType>::size, "Number of SCCs in the decomposition")
+        .def("__iter__", [](SCCDecomposition<ValueType> const& sccs) {
+                return py::make_iterator(sccs.begin(), sccs.end());
+            }, py::keep_alive<0, 1>() /* Essential: keep object alive while iterator exists */)
+        .def("flatten", [](SCCDecomposition<ValueType> const& sccs) {
+                return flattenDecomposition(sccs);
+            }, py::call_guard<py::gil_scoped_release>(), "Export the decomposition as flat arrays of states")
     ;
 
 }
@@ -38,3 +155,7 @@ template void define_maximal_end_component_decomposition<double>(py::module& m,
 template void define_maximal_end_component_decomposition<storm::RationalNumber>(py::module& m, std::string const& vt_suffix);
 template void define_maximal_end_component_decomposition<storm::Interval>(py::module& m, std::string const& vt_suffix);
 template void define_maximal_end_component_decomposition<storm::RationalFunction>(py::module& m, std::string const& vt_suffix);
+template void define_strongly_connected_component_decomposition<double>(py::module& m, std::string const& vt_suffix);
+template void define_strongly_connected_component_decomposition<storm::RationalNumber>(py::module& m, std::string const& vt_suffix);
+template void define_strongly_connected_component_decomposition<storm::Interval>(py::module& m, std::string const& vt_suffix);
+template void define_strongly_connected_component_decomposition<storm::RationalFunction>(py::module& m, std::string const& vt_suffix);
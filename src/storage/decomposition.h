@@ -6,3 +6,9 @@ void define_maximal_end_components(py::module& m);
 
 template<typename ValueType>
 void define_maximal_end_component_decomposition(py::module& m, std::string const& vt_suffix);
+
+void define_flat_decomposition(py::module& m);
+void define_strongly_connected_components(py::module& m);
+
+template<typename ValueType>
+void define_strongly_connected_component_decomposition(py::module& m, std::string const& vt_suffix);
@@ -1,9 +1,155 @@
 #include "labeling.h"
 #include "src/helpers.h"
+#include "src/numpy_helpers.h"
 
 #include "storm/models/sparse/ItemLabeling.h"
 #include "storm/models/sparse/StateLabeling.h"
 #include "storm/models/sparse/ChoiceLabeling.h"
+#include "storm/storage/BitVector.h"
+#include "storm/utility/macros.h"
+#include "storm/exceptions/InvalidArgumentException.h"
+
+#include <algorithm>
+
+// Labels in the order of their ids (sorted by name).
+// As the id is the position in the sorted list, ids are only stable as long as no label is added to the labeling.
+std::vector<std::string> getLabelList(storm::models::sparse::ItemLabeling const& labeling) {
+    auto labels = labeling.getLabels();
+    return std::vector<std::string>(labels.begin(), labels.end());
+}
+
+// Ids of the given labels. The sorted label set is only computed once for all labels.
+std::vector<uint64_t> getLabelIds(storm::models::sparse::ItemLabeling const& labeling, std::vector<std::string> const& labels) {
+    auto labelList = getLabelList(labeling);
+    std::vector<uint64_t> ids;
+    ids.reserve(labels.size());
+    for (auto const& label : labels) {
+        auto it = std::lower_bound(labelList.begin(), labelList.end(), label);
+        STORM_LOG_THROW(it != labelList.end() && *it == label, storm::exceptions::InvalidArgumentException, "Label '" << label << "' does not exist.");
+        ids.push_back(std::distance(labelList.begin(), it));
+    }
+    return ids;
+}
+
+uint64_t getLabelId(storm::models::sparse::ItemLabeling const& labeling, std::string const& label) {
+    return getLabelIds(labeling, {label}).front();
+}
+
+std::vector<std::string> selectLabels(storm::models::sparse::ItemLabeling const& labeling, std::optional<std::vector<std::string>> const& labels) {
+    if (!labels) {
+        return getLabelList(labeling);
+    }
+    for (auto const& label : *labels) {
+        STORM_LOG_THROW(labeling.containsLabel(label), storm::exceptions::InvalidArgumentException, "Label '" << label << "' does not exist.");
+    }
+    return *labels;
+}
+
+// Boolean matrix with one row per item and one column per label
+template<typename LabelingType, typename ItemsFunction>
+py::array_t<bool> toLabelMatrix(LabelingType const& labeling, std::optional<std::vector<std::string>> const& selectedLabels, ItemsFunction const& getItems) {
+    auto labels = selectLabels(labeling, selectedLabels);
+    py::array_t<bool> result({static_cast<py::ssize_t>(labeling.getNumberOfItems()), static_cast<py::ssize_t>(labels.size())});
+    std::fill(result.mutable_data(), result.mutable_data() + result.size(), false);
+    auto data = result.template mutable_unchecked<2>();
+    for (uint64_t j = 0; j < labels.size(); ++j) {
+        for (auto item : getItems(labeling, labels[j])) {
+            data(item, j) = true;
+        }
+    }
+    return result;
+}
+
+// Matrix with one row per label containing the items as bitset. Item i is bit i % 64 of word i / 64.
+template<typename LabelingType, typename ItemsFunction>
+py::array_t<uint64_t> toPackedLabels(LabelingType const& labeling, std::optional<std::vector<std::string>> const& selectedLabels, ItemsFunction const& getItems) {
+    auto labels = selectLabels(labeling, selectedLabels);
+    uint64_t words = (labeling.getNumberOfItems() + 63) / 64;
+    py::array_t<uint64_t> result({static_cast<py::ssize_t>(labels.size()), static_cast<py::ssize_t>(words)});
+    std::fill(result.mutable_data(), result.mutable_data() + result.size(), 0);
+    auto data = result.template mutable_unchecked<2>();
+    for (uint64_t j = 0; j < labels.size(); ++j) {
+        for (auto item : getItems(labeling, labels[j])) {
+            data(j, item / 64) |= 1ull << (item % 64);
+        }
+    }
+    return result;
+}
+
+/*!
+ * Snapshot of a labeling for queries by label id.
+ * The sorted list of labels and the items of each label are copied once when the index is built,
+ * hence queries by id neither copy the label set nor look up labels by name.
+ * Later changes of the labeling are not reflected in the index.
+ */
+class LabelIndex {
+public:
+    template<typename LabelingType, typename ItemsFunction>
+    LabelIndex(LabelingType const& labeling, ItemsFunction const& getItems) : labels(getLabelList(labeling)), itemCount(labeling.getNumberOfItems()) {
+        items.reserve(labels.size());
+        for (auto const& label : labels) {
+            items.push_back(getItems(labeling, label));
+        }
+    }
+
+    std::vector<std::string> const& getLabels() const {
+        return labels;
+    }
+
+    uint64_t getLabelId(std::string const& label) const {
+        auto it = std::lower_bound(labels.begin(), labels.end(), label);
+        STORM_LOG_THROW(it != labels.end() && *it == label, storm::exceptions::InvalidArgumentException, "Label '" << label << "' does not exist.");
+        return std::distance(labels.begin(), it);
+    }
+
+    std::vector<uint64_t> getLabelIds(std::vector<std::string> const& selectedLabels) const {
+        std::vector<uint64_t> ids;
+        ids.reserve(selectedLabels.size());
+        for (auto const& label : selectedLabels) {
+            ids.push_back(getLabelId(label));
+        }
+        return ids;
+    }
+
+    storm::storage::BitVector const& getItems(uint64_t id) const {
+        checkLabelId(id);
+        return items[id];
+    }
+
+    std::vector<uint64_t> getLabelIdsOfItem(uint64_t item) const {
+        STORM_LOG_THROW(item < itemCount, storm::exceptions::InvalidArgumentException, "Item " << item << " does not exist.");
+        std::vector<uint64_t> ids;
+        for (uint64_t id = 0; id < items.size(); ++id) {
+            if (items[id].get(item)) {
+                ids.push_back(id);
+            }
+        }
+        return ids;
+    }
+
+    storm::storage::BitVector getItemsWithLabelIds(std::vector<uint64_t> const& labelIds, bool requireAll) const {
+        storm::storage::BitVector result(itemCount, requireAll);
+        for (uint64_t id : labelIds) {
+            checkLabelId(id);
+            if (requireAll) {
+                result &= items[id];
+            } else {
+                result |= items[id];
+            }
+        }
+        return result;
+    }
+
+private:
+    void checkLabelId(uint64_t id) const {
+        STORM_LOG_THROW(id < labels.size(), storm::exceptions::InvalidArgumentException, "Label id " << id << " does not exist.");
+    }
+
+    std::vector<std::string> labels;
+    uint64_t itemCount;
+    // Items with the label of the corresponding id
+    std::vector<storm::storage::BitVector> items;
+};
 
 // Define python bindings
 void define_labeling(py::module& m) {
@@ -15,9 +161,22 @@ void define_labeling(py::module& m) {
             }, py::arg("label"), "Add label")
         .def("get_labels", &storm::models::sparse::ItemLabeling::getLabels, "Get all labels")
         .def("contains_label", &storm::models::sparse::ItemLabeling::containsLabel, "Check if the given label is contained in the labeling", py::arg("label"))
+        .def("get_label_list", &getLabelList, "Get all labels sorted by name. The position of a label in this list is its id. Adding a label changes the ids of all labels sorted after it.")
+        .def("get_label_id", &getLabelId, py::arg("label"), "Get the id of the given label. Ids are only valid as long as the labeling is not changed. For repeated queries, use a label index.")
+        .def("get_label_ids", &getLabelIds, py::arg("labels"), "Get the ids of the given labels. Ids are only valid as long as the labeling is not changed. For repeated queries, use a label index.")
         .def("__str__", &streamToString<storm::models::sparse::ItemLabeling>)
     ;
 
+    py::class_<LabelIndex>(m, "LabelIndex", "Snapshot of a labeling for fast queries by label id. Later changes of the labeling are not reflected.")
+        .def_property_readonly("labels", &LabelIndex::getLabels, "Labels sorted by name. The position of a label in this list is its id.")
+        .def("get_label_id", &LabelIndex::getLabelId, py::arg("label"), "Get the id of the given label")
+        .def("get_label_ids", &LabelIndex::getLabelIds, py::arg("labels"), "Get the ids of the given labels")
+        .def("get_items", &LabelIndex::getItems, py::arg("label_id"), "Get the items (states or choices) with the label of the given id")
+        .def("get_label_ids_of_item", &LabelIndex::getLabelIdsOfItem, py::arg("item"), "Get the ids of all labels of the given item (state or choice)")
+        .def("get_items_with_label_ids", &LabelIndex::getItemsWithLabelIds, py::arg("label_ids"), py::arg("require_all") = false,
+             "Get the items (states or choices) which have any (or all if require_all is set) of the labels with the given ids")
+    ;
+
 
     // StateLabeling
     py::class_<storm::models::sparse::StateLabeling, std::shared_ptr<storm::models::sparse::StateLabeling>>(m, "StateLabeling", "Labeling for states", labeling)
@@ -29,6 +188,28 @@ void define_labeling(py::module& m) {
         .def("set_states", [](storm::models::sparse::StateLabeling& labeling, std::string const& label, storm::storage::BitVector const& states) {
                 labeling.setStates(label, states);
             }, "Add a label to the given states", py::arg("label"), py::arg("states"))
+        .def("get_label_index", [](storm::models::sparse::StateLabeling const& labeling) {
+                return LabelIndex(labeling, [](storm::models::sparse::StateLabeling const& l, std::string const& label) -> storm::storage::BitVector const& { return l.getStates(label); });
+            }, "Build an index for queries by label id (e.g., the label ids of a state or the states with given label ids)")
+        .def("to_matrix", [](storm::models::sparse::StateLabeling const& labeling, std::optional<std::vector<std::string>> const& labels) {
+                return toLabelMatrix(labeling, labels, [](storm::models::sparse::StateLabeling const& l, std::string const& label) -> storm::storage::BitVector const& { return l.getStates(label); });
+            }, py::arg("labels") = std::nullopt, R"dox(
+
+            Get the labeling as boolean NumPy matrix.
+
+            :param List[str] labels: Labels corresponding to the columns. If None, all labels sorted by name (i.e., by id) are used.
+            :return: Matrix with one row per state and one column per label
+            )dox")
+        .def("to_packed_bitsets", [](storm::models::sparse::StateLabeling const& labeling, std::optional<std::vector<std::string>> const& labels) {
+                return toPackedLabels(labeling, labels, [](storm::models::sparse::StateLabeling const& l, std::string const& label) -> storm::storage::BitVector const& { return l.getStates(label); });
+            }, py::arg("labels") = std::nullopt, R"dox(
+
+            Get the labeling as packed bitsets in a NumPy matrix of 64-bit words.
+            State i has label j iff bit i % 64 of entry [j, i // 64] is set.
+
+            :param List[str] labels: Labels corresponding to the rows. If None, all labels sorted by name (i.e., by id) are used.
+            :return: Matrix with one row per label
+            )dox")
         .def("__str__", &streamToString<storm::models::sparse::StateLabeling>)
     ;
 
@@ -41,6 +222,15 @@ void define_labeling(py::module& m) {
             .def("set_choices", [](storm::models::sparse::ChoiceLabeling& labeling, std::string const& label, storm::storage::BitVector const& choices) {
                 labeling.setChoices(label, choices);
             },  "Add a label to a the given choices", py::arg("label"), py::arg("choices"))
+            .def("to_matrix", [](storm::models::sparse::ChoiceLabeling const& labeling, std::optional<std::vector<std::string>> const& labels) {
+                return toLabelMatrix(labeling, labels, [](storm::models::sparse::ChoiceLabeling const& l, std::string const& label) -> storm::storage::BitVector const& { return l.getChoices(label); });
+            }, py::arg("labels") = std::nullopt, "Get the labeling as boolean NumPy matrix with one row per choice and one column per label")
+            .def("to_packed_bitsets", [](storm::models::sparse::ChoiceLabeling const& labeling, std::optional<std::vector<std::string>> const& labels) {
+                return toPackedLabels(labeling, labels, [](storm::models::sparse::ChoiceLabeling const& l, std::string const& label) -> storm::storage::BitVector const& { return l.getChoices(label); });
+            }, py::arg("labels") = std::nullopt, "Get the labeling as packed bitsets in a NumPy matrix of 64-bit words with one row per label")
+            .def("get_label_index", [](storm::models::sparse::ChoiceLabeling const& labeling) {
+                return LabelIndex(labeling, [](storm::models::sparse::ChoiceLabeling const& l, std::string const& label) -> storm::storage::BitVector const& { return l.getChoices(label); });
+            }, "Build an index for queries by label id (e.g., the label ids of a choice or the choices with given label ids)")
             .def("__str__", &streamToString<storm::models::sparse::ChoiceLabeling>)
     ;
 }
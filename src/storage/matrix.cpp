@@ -2,8 +2,12 @@
 #include "storm/adapters/RationalFunctionAdapter.h"
 #include "storm/storage/SparseMatrix.h"
 #include "storm/storage/BitVector.h"
+#include "storm/solver/OptimizationDirection.h"
 #include "storm/utility/graph.h"
 #include "src/helpers.h"
+#include "src/numpy_helpers.h"
+
+#include <type_traits>
 
 template<typename ValueType> using SparseMatrix = storm::storage::SparseMatrix<ValueType>;
 template<typename ValueType> using SparseMatrixBuilder = storm::storage::SparseMatrixBuilder<ValueType>;
@@ -15,6 +19,11 @@ using row_index = unsigned int;
 void define_sparse_matrix_nt(py::module& m) {
     m.def("_topological_sort_double", [](SparseMatrix<double>& matrix, std::vector<uint64_t> initial) { return storm::utility::graph::getTopologicalSort(matrix, initial); }, "matrix"_a, "initial"_a,  "get topological sort w.r.t. a transition matrix");
     m.def("_topological_sort_rf", [](SparseMatrix<storm::RationalFunction>& matrix, std::vector<uint64_t> initial) { return storm::utility::graph::getTopologicalSort(matrix, initial); }, "matrix"_a, "initial"_a,  "get topological sort w.r.t. a transition matrix");
+    m.def("_multiply_and_reduce_double", [](SparseMatrix<double> const& matrix, storm::solver::OptimizationDirection dir, std::vector<double> const& x, std::optional<std::vector<double>> const& summand) {
+            std::vector<double> result(matrix.getRowGroupCount());
+            matrix.multiplyAndReduce(dir, matrix.getRowGroupIndices(), x, summand ? &summand.value() : nullptr, result, nullptr);
+            return result;
+        }, "matrix"_a, "direction"_a, "vector"_a, "summand"_a = std::nullopt, "multiply with vector, add summand and take minimum/maximum over each row group");
 }
 
 template<typename ValueType>
@@ -65,7 +74,8 @@ void define_sparse_matrix(py::module& m, std::string const& vtSuffix) {
     ;
 
     // SparseMatrix
-    py::class_<SparseMatrix<ValueType>>(m, (vtSuffix + "SparseMatrix").c_str(), "Sparse matrix")
+    py::class_<SparseMatrix<ValueType>> sparseMatrix(m, (vtSuffix + "SparseMatrix").c_str(), "Sparse matrix");
+    sparseMatrix
         .def("__iter__", [](SparseMatrix<ValueType>& matrix) {
                 return py::make_iterator(matrix.begin(), matrix.end());
             }, py::keep_alive<0, 1>() /* Essential: keep object alive while iterator exists */)
@@ -73,6 +83,7 @@ void define_sparse_matrix(py::module& m, std::string const& vtSuffix) {
         .def_property_readonly("nr_rows", &SparseMatrix<ValueType>::getRowCount, "Number of rows")
         .def_property_readonly("nr_columns", &SparseMatrix<ValueType>::getColumnCount, "Number of columns")
         .def_property_readonly("nr_entries", &SparseMatrix<ValueType>::getEntryCount, "Number of non-zero entries")
+        .def_property_readonly("size_in_memory", &SparseMatrix<ValueType>::getSizeInMemory, "Size of the matrix in memory (in bytes)")
 
         .def("get_row_group_start", [](SparseMatrix<ValueType>& matrix, entry_index<ValueType> row) {return matrix.getRowGroupIndices()[row];})
         .def("get_row_group_end", [](SparseMatrix<ValueType>& matrix, entry_index<ValueType> row) {return matrix.getRowGroupIndices()[row+1];})
@@ -118,6 +129,12 @@ void define_sparse_matrix(py::module& m, std::string const& vtSuffix) {
             }, py::return_value_policy::reference, py::keep_alive<1, 0>())
     ;
 
+    if constexpr (std::is_same_v<ValueType, double>) {
+        sparseMatrix.def_property_readonly("value_array", [](py::object const& self) {
+                return matrixValuesAsNumpy(self.cast<SparseMatrix<double> const&>(), self);
+            }, "Values of all entries (row by row) as read-only NumPy array without copying. To change the values of a model, use substitute_transition_values on a modified copy.");
+    }
+
 
     // Rows
     py::class_<typename SparseMatrix<ValueType>::rows>(m, (vtSuffix + "SparseMatrixRows").c_str(), "Set of rows in a sparse matrix")
@@ -22,12 +22,20 @@
 
 #include "storm/storage/Scheduler.h"
 
+#include "storm/utility/macros.h"
+#include "storm/utility/ConstantsComparator.h"
+#include "storm/exceptions/InvalidOperationException.h"
+
+#include "src/numpy_helpers.h"
+
 #include <functional>
 #include <string>
 #include <sstream>
+#include <type_traits>
 
 // Typedefs
 using RationalFunction = storm::RationalFunction;
+using NumpyVector = py::array_t<double, py::array::c_style | py::array::forcecast>;
 using ModelBase = storm::models::ModelBase;
 
 template<typename ValueType> using ModelComponents = storm::storage::sparse::ModelComponents<ValueType>;
@@ -51,6 +59,42 @@ template<storm::dd::DdType DdType, typename ValueType> using SymbolicRewardModel
 
 
 // Thin wrappers
+std::optional<std::vector<double>> numpyToOptionalVector(std::optional<NumpyVector> const& array) {
+    if (!array) {
+        return std::nullopt;
+    }
+    STORM_LOG_THROW(array->ndim() == 1, storm::exceptions::InvalidOperationException, "Expected one-dimensional array.");
+    return std::vector<double>(array->data(), array->data() + array->size());
+}
+
+// Copy the components of the model but replace the values of the transition matrix.
+// Each row must be a probability distribution (up to the default precision).
+template<typename ModelType>
+ModelComponents<double> substituteTransitionValues(ModelType const& model, NumpyVector const& values) {
+    storm::storage::SparseMatrix<double> const& original = model.getTransitionMatrix();
+    STORM_LOG_THROW(values.ndim() == 1 && static_cast<uint64_t>(values.size()) == original.getEntryCount(), storm::exceptions::InvalidOperationException,
+                    "Expected one-dimensional array with " << original.getEntryCount() << " values but got " << values.size() << ".");
+    storm::storage::SparseMatrix<double> matrix(original);
+    double const* value = values.data();
+    for (auto& entry : matrix) {
+        entry.setValue(*value++);
+    }
+    storm::utility::ConstantsComparator<double> comparator;
+    for (uint64_t row = 0; row < matrix.getRowCount(); ++row) {
+        double sum = 0;
+        for (auto const& entry : matrix.getRow(row)) {
+            STORM_LOG_THROW(entry.getValue() >= 0, storm::exceptions::InvalidOperationException, "Negative value " << entry.getValue() << " in row " << row << ".");
+            sum += entry.getValue();
+        }
+        STORM_LOG_THROW(comparator.isOne(sum), storm::exceptions::InvalidOperationException, "Values of row " << row << " sum up to " << sum << " instead of 1.");
+    }
+    ModelComponents<double> components(std::move(matrix), model.getStateLabeling(), model.getRewardModels());
+    components.choiceLabeling = model.getOptionalChoiceLabeling();
+    components.stateValuations = model.getOptionalStateValuations();
+    components.choiceOrigins = model.getOptionalChoiceOrigins();
+    return components;
+}
+
 template<typename ValueType>
 std::vector<storm::storage::sparse::state_type> getSparseInitialStates(SparseModel<ValueType> const& model) {
     std::vector<storm::storage::sparse::state_type> initialStates;
@@ -235,8 +279,8 @@ void define_sparse_model(py::module& m, std::string const& vtSuffix) {
     py::class_<SparseNondeterministicModel<ValueType>, std::shared_ptr<SparseNondeterministicModel<ValueType>>> nondetModel(m, ("_SparseNondeterministic" + vtSuffix + "Model").c_str(), "Nondeterministic sparse model", model)
     ;
 
-    py::class_<SparseDtmc<ValueType>, std::shared_ptr<SparseDtmc<ValueType>>>(m, ("Sparse" + vtSuffix + "Dtmc").c_str(), "DTMC in sparse representation", detModel)
-        .def(py::init<SparseDtmc<ValueType>>(), py::arg("other_model"))
+    py::class_<SparseDtmc<ValueType>, std::shared_ptr<SparseDtmc<ValueType>>> dtmc(m, ("Sparse" + vtSuffix + "Dtmc").c_str(), "DTMC in sparse representation", detModel);
+    dtmc.def(py::init<SparseDtmc<ValueType>>(), py::arg("other_model"))
         .def(py::init<ModelComponents<ValueType> const&>(), py::arg("components"))
         .def("__str__", &getModelInfoPrinter)
     ;
@@ -249,8 +293,8 @@ void define_sparse_model(py::module& m, std::string const& vtSuffix) {
         .def("apply_scheduler", [](SparseMdp<ValueType> const& mdp, storm::storage::Scheduler<ValueType> const& scheduler, bool dropUnreachableStates) { return mdp.applyScheduler(scheduler, dropUnreachableStates); } , "apply scheduler", "scheduler"_a, "drop_unreachable_states"_a = true)
         .def("__str__", &getModelInfoPrinter)
     ;
-    py::class_<SparsePomdp<ValueType>, std::shared_ptr<SparsePomdp<ValueType>>>(m, ("Sparse" + vtSuffix + "Pomdp").c_str(), "POMDP in sparse representation", mdp)
-        .def(py::init<SparsePomdp<ValueType>>(), py::arg("other_model"))
+    py::class_<SparsePomdp<ValueType>, std::shared_ptr<SparsePomdp<ValueType>>> pomdp(m, ("Sparse" + vtSuffix + "Pomdp").c_str(), "POMDP in sparse representation", mdp);
+    pomdp.def(py::init<SparsePomdp<ValueType>>(), py::arg("other_model"))
         .def(py::init<ModelComponents<ValueType> const&, bool>(), py::arg("components"), py::arg("canonic_flag")=false)
         .def("__str__", &getModelInfoPrinter)
         .def("get_observation", &SparsePomdp<ValueType>::getObservation, py::arg("state"))
@@ -259,6 +303,40 @@ void define_sparse_model(py::module& m, std::string const& vtSuffix) {
         .def("has_observation_valuations", &SparsePomdp<ValueType>::hasObservationValuations)
         .def_property_readonly("observation_valuations", &SparsePomdp<ValueType>::getObservationValuations)
     ;
+    if constexpr (std::is_same_v<ValueType, double>) {
+        dtmc.def("substitute_transition_values", [](SparseDtmc<double> const& dtmc, NumpyVector const& values) {
+                return std::make_shared<SparseDtmc<double>>(substituteTransitionValues(dtmc, values));
+            }, py::arg("values"), R"dox(
+
+            Create a DTMC with the same structure, labeling and reward models but new transition probabilities.
+
+            :param values: Array with one value per entry of the transition matrix, in the order of transition_matrix.value_array
+            :return: New DTMC
+            )dox");
+        mdp.def("substitute_transition_values", [](SparseMdp<double> const& mdp, NumpyVector const& values) {
+                return std::make_shared<SparseMdp<double>>(substituteTransitionValues(mdp, values));
+            }, py::arg("values"), R"dox(
+
+            Create an MDP with the same structure, labeling and reward models but new transition probabilities.
+
+            :param values: Array with one value per entry of the transition matrix, in the order of transition_matrix.value_array
+            :return: New MDP
+            )dox");
+        pomdp.def("substitute_transition_values", [](SparsePomdp<double> const& pomdp, NumpyVector const& values) {
+                auto components = substituteTransitionValues(pomdp, values);
+                components.observabilityClasses = pomdp.getObservations();
+                if (pomdp.hasObservationValuations()) {
+                    components.observationValuations = pomdp.getObservationValuations();
+                }
+                return std::make_shared<SparsePomdp<double>>(std::move(components), pomdp.isCanonic());
+            }, py::arg("values"), R"dox(
+
+            Create a POMDP with the same structure, observations, labeling and reward models but new transition probabilities.
+
+            :param values: Array with one value per entry of the transition matrix, in the order of transition_matrix.value_array
+            :return: New POMDP
+            )dox");
+    }
     py::class_<SparseCtmc<ValueType>, std::shared_ptr<SparseCtmc<ValueType>>>(m, ("Sparse" + vtSuffix + "Ctmc").c_str(), "CTMC in sparse representation", detModel)
         .def(py::init<SparseCtmc<ValueType>>(), py::arg("other_model"))
         .def(py::init<ModelComponents<ValueType> const&>(), py::arg("components"))
@@ -277,8 +355,8 @@ void define_sparse_model(py::module& m, std::string const& vtSuffix) {
         .def("convert_to_ctmc", &SparseMarkovAutomaton<ValueType>::convertToCtmc, "Convert the MA into a CTMC.")
     ;
 
-    py::class_<SparseRewardModel<ValueType>>(m, ("Sparse" + vtSuffix + "RewardModel").c_str(), "Reward structure for sparse models")
-        .def(py::init<std::optional<std::vector<ValueType>> const&, std::optional<std::vector<ValueType>> const&,
+    py::class_<SparseRewardModel<ValueType>> rewardModel(m, ("Sparse" + vtSuffix + "RewardModel").c_str(), "Reward structure for sparse models");
+    rewardModel.def(py::init<std::optional<std::vector<ValueType>> const&, std::optional<std::vector<ValueType>> const&,
                 std::optional<storm::storage::SparseMatrix<ValueType>> const&>(), py::arg("optional_state_reward_vector") = std::nullopt,
                 py::arg("optional_state_action_reward_vector") = std::nullopt,  py::arg("optional_transition_reward_matrix") = std::nullopt)
         .def_property_readonly("has_state_rewards", &SparseRewardModel<ValueType>::hasStateRewards)
@@ -294,6 +372,37 @@ void define_sparse_model(py::module& m, std::string const& vtSuffix) {
         .def("reduce_to_state_based_rewards", [](SparseRewardModel<ValueType>& rewardModel, storm::storage::SparseMatrix<ValueType> const& transitions, bool onlyStateRewards){return rewardModel.reduceToStateBasedRewards(transitions, onlyStateRewards);},  py::arg("transition_matrix"), py::arg("only_state_rewards"), "Reduce to state-based rewards")
     ;
 
+    if constexpr (std::is_same_v<ValueType, double>) {
+        // Zero-copy access to the reward vectors
+        rewardModel.def_static("from_arrays", [](std::optional<NumpyVector> const& stateRewards, std::optional<NumpyVector> const& stateActionRewards,
+                                                 std::optional<storm::storage::SparseMatrix<double>> const& transitionRewards) {
+                    return SparseRewardModel<double>(numpyToOptionalVector(stateRewards), numpyToOptionalVector(stateActionRewards), transitionRewards);
+                }, py::arg("state_rewards") = std::nullopt, py::arg("state_action_rewards") = std::nullopt, py::arg("transition_rewards") = std::nullopt, R"dox(
+
+                Create a reward model from NumPy arrays.
+
+                :param state_rewards: Array with one reward per state
+                :param state_action_rewards: Array with one reward per choice
+                :param SparseMatrix transition_rewards: Matrix with transition rewards
+                :return: Reward model
+                )dox")
+            .def_property_readonly("state_reward_array", [](py::object const& self) {
+                    auto& rewardModel = self.cast<SparseRewardModel<double>&>();
+                    STORM_LOG_THROW(rewardModel.hasStateRewards(), storm::exceptions::InvalidOperationException, "Reward model has no state rewards.");
+                    return vectorAsNumpy(rewardModel.getStateRewardVector(), self, true);
+                }, "State rewards as NumPy array. The array is a view on the reward model, i.e., modifications change the rewards.")
+            .def_property_readonly("state_action_reward_array", [](py::object const& self) {
+                    auto& rewardModel = self.cast<SparseRewardModel<double>&>();
+                    STORM_LOG_THROW(rewardModel.hasStateActionRewards(), storm::exceptions::InvalidOperationException, "Reward model has no state-action rewards.");
+                    return vectorAsNumpy(rewardModel.getStateActionRewardVector(), self, true);
+                }, "State-action rewards as NumPy array. The array is a view on the reward model, i.e., modifications change the rewards.")
+            .def_property_readonly("transition_reward_array", [](py::object const& self) {
+                    auto& rewardModel = self.cast<SparseRewardModel<double>&>();
+                    STORM_LOG_THROW(rewardModel.hasTransitionRewards(), storm::exceptions::InvalidOperationException, "Reward model has no transition rewards.");
+                    return matrixValuesAsNumpy(rewardModel.getTransitionRewardMatrix(), self, true);
+                }, "Values of the transition reward matrix in the order of its entries as NumPy array. The array is a view on the reward model, i.e., modifications change the rewards.")
+        ;
+    }
 }
 
 void define_sparse_parametric_model(py::module& m) {
@@ -0,0 +1,409 @@
+#include "parallel_decomposition.h"
+#include "src/numpy_helpers.h"
+
+#include "storm/models/sparse/Model.h"
+#include "storm/models/sparse/NondeterministicModel.h"
+#include "storm/storage/SparseMatrix.h"
+#include "storm/adapters/RationalFunctionAdapter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <limits>
+#include <mutex>
+#include <numeric>
+#include <thread>
+
+template<typename ValueType> using SparseMatrix = storm::storage::SparseMatrix<ValueType>;
+
+// Result of a parallel decomposition. Components are numbered in the order of their smallest state.
+struct ParallelDecompositionResult {
+    uint64_t componentCount = 0;
+    // Component of each state or -1 if the state belongs to no component
+    std::vector<int64_t> stateComponents;
+    // Component of each choice or -1 if the choice belongs to no component. Empty for SCC decompositions.
+    std::vector<int64_t> choiceComponents;
+};
+
+/*!
+ * Multithreaded decomposition into strongly connected components (SCCs) or maximal end components (MECs).
+ * SCCs are computed with the forward-backward algorithm: the states reachable from a pivot are split from the rest, and
+ * the SCC of the pivot is the set of states in the forward set which reach the pivot. The forward set without the SCC and
+ * the remaining states form independent subproblems which are processed in parallel. States without incoming or outgoing
+ * edges are trimmed beforehand as trivial SCCs.
+ * For MECs, each SCC is refined by removing the choices leaving it and the states without remaining choices.
+ * Refined SCCs are decomposed again until no choice is removed.
+ * Each subproblem is identified by a unique color, and states carry the color of the subproblem they belong to.
+ */
+template<typename ValueType>
+class ParallelDecomposer {
+public:
+    ParallelDecomposer(SparseMatrix<ValueType> const& matrix, bool endComponents, uint64_t threads)
+        : matrix(matrix), rowGroupIndices(matrix.getRowGroupIndices()), endComponents(endComponents),
+          threads(threads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : threads), stateColors(matrix.getRowGroupCount()),
+          inDegree(matrix.getRowGroupCount()), outDegree(matrix.getRowGroupCount()), choiceEnabled(matrix.getRowCount(), true) {
+        uint64_t stateCount = matrix.getRowGroupCount();
+        for (auto& color : stateColors) {
+            color.store(0, std::memory_order_relaxed);
+        }
+
+        // Build predecessor lists
+        predecessorOffsets.assign(stateCount + 1, 0);
+        for (uint64_t row = 0; row < matrix.getRowCount(); ++row) {
+            for (auto const& entry : matrix.getRow(row)) {
+                ++predecessorOffsets[entry.getColumn() + 1];
+            }
+        }
+        std::partial_sum(predecessorOffsets.begin(), predecessorOffsets.end(), predecessorOffsets.begin());
+        predecessorStates.resize(predecessorOffsets.back());
+        predecessorChoices.resize(predecessorOffsets.back());
+        std::vector<uint64_t> positions(predecessorOffsets.begin(), predecessorOffsets.end() - 1);
+        for (uint64_t state = 0; state < stateCount; ++state) {
+            for (uint64_t row = rowGroupIndices[state]; row < rowGroupIndices[state + 1]; ++row) {
+                for (auto const& entry : matrix.getRow(row)) {
+                    uint64_t position = positions[entry.getColumn()]++;
+                    predecessorStates[position] = state;
+                    predecessorChoices[position] = row;
+                }
+            }
+        }
+    }
+
+    ParallelDecompositionResult decompose() {
+        std::vector<uint64_t> states(matrix.getRowGroupCount());
+        std::iota(states.begin(), states.end(), 0);
+        if (!states.empty()) {
+            queue.push_back(Task{std::move(states), 0});
+        }
+        if (threads == 1) {
+            work();
+        } else {
+            std::vector<std::thread> workers;
+            for (uint64_t i = 0; i < threads; ++i) {
+                workers.emplace_back([this]() { work(); });
+            }
+            for (auto& worker : workers) {
+                worker.join();
+            }
+        }
+        return collectResult();
+    }
+
+private:
+    struct Task {
+        std::vector<uint64_t> states;
+        uint64_t color;
+    };
+
+    // Subproblems with fewer states are processed by the current thread
+    static constexpr uint64_t parallelThreshold = 1024;
+    static constexpr uint64_t removedColor = std::numeric_limits<uint64_t>::max();
+
+    SparseMatrix<ValueType> const& matrix;
+    std::vector<uint64_t> const& rowGroupIndices;
+    bool endComponents;
+    uint64_t threads;
+
+    std::vector<uint64_t> predecessorOffsets;
+    std::vector<uint64_t> predecessorStates;
+    std::vector<uint64_t> predecessorChoices;
+
+    // Colors are read across subproblems, all other state and choice data is only accessed by the subproblem owning the state
+    std::vector<std::atomic<uint64_t>> stateColors;
+    std::atomic<uint64_t> nextColor{1};
+    std::vector<uint64_t> inDegree;
+    std::vector<uint64_t> outDegree;
+    std::vector<char> choiceEnabled;
+
+    std::mutex queueMutex;
+    std::condition_variable queueCondition;
+    std::vector<Task> queue;
+    uint64_t activeTasks = 0;
+
+    std::mutex componentMutex;
+    std::vector<std::vector<uint64_t>> components;
+
+    uint64_t getColor(uint64_t state) const {
+        return stateColors[state].load(std::memory_order_relaxed);
+    }
+
+    void setColor(uint64_t state, uint64_t color) {
+        stateColors[state].store(color, std::memory_order_relaxed);
+    }
+
+    void work() {
+        while (true) {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock(queueMutex);
+                queueCondition.wait(lock, [this]() { return !queue.empty() || activeTasks == 0; });
+                if (queue.empty()) {
+                    return;
+                }
+                task = std::move(queue.back());
+                queue.pop_back();
+                ++activeTasks;
+            }
+            process(std::move(task));
+            {
+                std::lock_guard<std::mutex> lock(queueMutex);
+                --activeTasks;
+            }
+            queueCondition.notify_all();
+        }
+    }
+
+    void schedule(Task&& task, std::vector<Task>& localTasks) {
+        if (task.states.size() < parallelThreshold || threads == 1) {
+            localTasks.push_back(std::move(task));
+        } else {
+            {
+                std::lock_guard<std::mutex> lock(queueMutex);
+                queue.push_back(std::move(task));
+            }
+            queueCondition.notify_one();
+        }
+    }
+
+    void process(Task&& initialTask) {
+        std::vector<Task> localTasks;
+        localTasks.push_back(std::move(initialTask));
+        while (!localTasks.empty()) {
+            Task task = std::move(localTasks.back());
+            localTasks.pop_back();
+            uint64_t color = task.color;
+            trim(task.states, color, localTasks);
+            if (task.states.empty()) {
+                continue;
+            }
+
+            uint64_t pivot = task.states.front();
+            uint64_t forwardColor = nextColor++;
+            std::vector<uint64_t> forward = search(pivot, color, forwardColor, true);
+            uint64_t componentColor = nextColor++;
+            std::vector<uint64_t> component = search(pivot, forwardColor, componentColor, false);
+
+            Task forwardTask{{}, forwardColor};
+            for (uint64_t state : forward) {
+                if (getColor(state) == forwardColor) {
+                    forwardTask.states.push_back(state);
+                }
+            }
+            Task remainingTask{{}, color};
+            for (uint64_t state : task.states) {
+                if (getColor(state) == color) {
+                    remainingTask.states.push_back(state);
+                }
+            }
+            addComponent(std::move(component), componentColor, localTasks);
+            if (!forwardTask.states.empty()) {
+                schedule(std::move(forwardTask), localTasks);
+            }
+            if (!remainingTask.states.empty()) {
+                schedule(std::move(remainingTask), localTasks);
+            }
+        }
+    }
+
+    // Recolors all states with color fromColor which are reachable from (or reach) the pivot.
+    std::vector<uint64_t> search(uint64_t pivot, uint64_t fromColor, uint64_t toColor, bool forward) {
+        std::vector<uint64_t> result = {pivot};
+        setColor(pivot, toColor);
+        for (uint64_t i = 0; i < result.size(); ++i) {
+            uint64_t state = result[i];
+            if (forward) {
+                for (uint64_t row = rowGroupIndices[state]; row < rowGroupIndices[state + 1]; ++row) {
+                    if (!choiceEnabled[row]) {
+                        continue;
+                    }
+                    for (auto const& entry : matrix.getRow(row)) {
+                        if (getColor(entry.getColumn()) == fromColor) {
+                            setColor(entry.getColumn(), toColor);
+                            result.push_back(entry.getColumn());
+                        }
+                    }
+                }
+            } else {
+                for (uint64_t k = predecessorOffsets[state]; k < predecessorOffsets[state + 1]; ++k) {
+                    uint64_t predecessor = predecessorStates[k];
+                    if (getColor(predecessor) == fromColor && choiceEnabled[predecessorChoices[k]]) {
+                        setColor(predecessor, toColor);
+                        result.push_back(predecessor);
+                    }
+                }
+            }
+        }
+        return result;
+    }
+
+    // Removes states without incoming or outgoing edges within the subproblem. Each of them forms a trivial SCC.
+    void trim(std::vector<uint64_t>& states, uint64_t color, std::vector<Task>& localTasks) {
+        std::vector<uint64_t> candidates;
+        for (uint64_t state : states) {
+            outDegree[state] = 0;
+            for (uint64_t row = rowGroupIndices[state]; row < rowGroupIndices[state + 1]; ++row) {
+                if (choiceEnabled[row]) {
+                    for (auto const& entry : matrix.getRow(row)) {
+                        outDegree[state] += getColor(entry.getColumn()) == color ? 1 : 0;
+                    }
+                }
+            }
+            inDegree[state] = 0;
+            for (uint64_t k = predecessorOffsets[state]; k < predecessorOffsets[state + 1]; ++k) {
+                if (getColor(predecessorStates[k]) == color && choiceEnabled[predecessorChoices[k]]) {
+                    ++inDegree[state];
+                }
+            }
+            if (inDegree[state] == 0 || outDegree[state] == 0) {
+                candidates.push_back(state);
+            }
+        }
+        if (candidates.empty()) {
+            return;
+        }
+
+        while (!candidates.empty()) {
+            uint64_t state = candidates.back();
+            candidates.pop_back();
+            if (getColor(state) != color) {
+                // Already trimmed
+                continue;
+            }
+            uint64_t trivialColor = nextColor++;
+            setColor(state, trivialColor);
+            for (uint64_t row = rowGroupIndices[state]; row < rowGroupIndices[state + 1]; ++row) {
+                if (choiceEnabled[row]) {
+                    for (auto const& entry : matrix.getRow(row)) {
+                        if (getColor(entry.getColumn()) == color && --inDegree[entry.getColumn()] == 0) {
+                            candidates.push_back(entry.getColumn());
+                        }
+                    }
+                }
+            }
+            for (uint64_t k = predecessorOffsets[state]; k < predecessorOffsets[state + 1]; ++k) {
+                if (getColor(predecessorStates[k]) == color && choiceEnabled[predecessorChoices[k]] && --outDegree[predecessorStates[k]] == 0) {
+                    candidates.push_back(predecessorStates[k]);
+                }
+            }
+            addComponent({state}, trivialColor, localTasks);
+        }
+        states.erase(std::remove_if(states.begin(), states.end(), [this, color](uint64_t state) { return getColor(state) != color; }), states.end());
+    }
+
+    void addComponent(std::vector<uint64_t>&& component, uint64_t color, std::vector<Task>& localTasks) {
+        if (endComponents) {
+            // Remove choices leaving the component and states without remaining choices
+            bool changed = false;
+            for (uint64_t state : component) {
+                bool hasChoice = false;
+                for (uint64_t row = rowGroupIndices[state]; row < rowGroupIndices[state + 1]; ++row) {
+                    if (!choiceEnabled[row]) {
+                        continue;
+                    }
+                    auto const& entries = matrix.getRow(row);
+                    bool staysInside = entries.begin() != entries.end();
+                    for (auto const& entry : entries) {
+                        if (getColor(entry.getColumn()) != color) {
+                            staysInside = false;
+                            break;
+                        }
+                    }
+                    if (staysInside) {
+                        hasChoice = true;
+                    } else {
+                        choiceEnabled[row] = false;
+                        changed = true;
+                    }
+                }
+                if (!hasChoice) {
+                    setColor(state, removedColor);
+                    changed = true;
+                }
+            }
+            if (changed) {
+                // The remaining states may still contain end components
+                Task refinedTask{{}, color};
+                for (uint64_t state : component) {
+                    if (getColor(state) == color) {
+                        refinedTask.states.push_back(state);
+                    }
+                }
+                if (!refinedTask.states.empty()) {
+                    schedule(std::move(refinedTask), localTasks);
+                }
+                return;
+            }
+        }
+        std::lock_guard<std::mutex> lock(componentMutex);
+        components.push_back(std::move(component));
+    }
+
+    ParallelDecompositionResult collectResult() {
+        for (auto& component : components) {
+            std::sort(component.begin(), component.end());
+        }
+        std::sort(components.begin(), components.end(), [](std::vector<uint64_t> const& a, std::vector<uint64_t> const& b) { return a.front() < b.front(); });
+
+        ParallelDecompositionResult result;
+        result.componentCount = components.size();
+        result.stateComponents.assign(matrix.getRowGroupCount(), -1);
+        if (endComponents) {
+            result.choiceComponents.assign(matrix.getRowCount(), -1);
+        }
+        for (uint64_t index = 0; index < components.size(); ++index) {
+            for (uint64_t state : components[index]) {
+                result.stateComponents[state] = index;
+                if (endComponents) {
+                    for (uint64_t row = rowGroupIndices[state]; row < rowGroupIndices[state + 1]; ++row) {
+                        if (choiceEnabled[row]) {
+                            result.choiceComponents[row] = index;
+                        }
+                    }
+                }
+            }
+        }
+        return result;
+    }
+};
+
+
+template<typename ValueType>
+void define_parallel_decomposition(py::module& m, std::string const& vt_suffix) {
+    m.def(("parallel_strongly_connected_components" + vt_suffix).c_str(), [](storm::models::sparse::Model<ValueType> const& model, uint64_t threads) {
+            return ParallelDecomposer<ValueType>(model.getTransitionMatrix(), false, threads).decompose();
+        }, py::arg("model"), py::arg("threads") = 0, py::call_guard<py::gil_scoped_release>(), R"dox(
+
+        Compute the strongly connected components of the model with multiple threads.
+
+        :param model: The model
+        :param int threads: Number of threads. If 0, the number of hardware threads is used.
+        :return: Component of each state
+        )dox");
+    m.def(("parallel_maximal_end_components" + vt_suffix).c_str(), [](storm::models::sparse::NondeterministicModel<ValueType> const& model, uint64_t threads) {
+            return ParallelDecomposer<ValueType>(model.getTransitionMatrix(), true, threads).decompose();
+        }, py::arg("model"), py::arg("threads") = 0, py::call_guard<py::gil_scoped_release>(), R"dox(
+
+        Compute the maximal end components of the model with multiple threads.
+
+        :param model: The model
+        :param int threads: Number of threads. If 0, the number of hardware threads is used.
+        :return: Component of each state and each choice
+        )dox");
+}
+
+void define_parallel_decomposition_result(py::module& m) {
+    py::class_<ParallelDecompositionResult, std::shared_ptr<ParallelDecompositionResult>>(m, "ParallelDecompositionResult", "Decomposition as flat arrays of component indices")
+        .def_readonly("nr_components", &ParallelDecompositionResult::componentCount, "Number of components")
+        .def_property_readonly("state_components", [](py::object const& self) {
+                return vectorAsNumpy(self.cast<ParallelDecompositionResult const&>().stateComponents, self);
+            }, "Component of each state as NumPy array (-1 if the state belongs to no component)")
+        .def_property_readonly("choice_components", [](py::object const& self) {
+                return vectorAsNumpy(self.cast<ParallelDecompositionResult const&>().choiceComponents, self);
+            }, "Component of each choice as NumPy array (-1 if the choice belongs to no component). Empty for SCC decompositions.")
+    ;
+}
+
+template void define_parallel_decomposition<double>(py::module& m, std::string const& vt_suffix);
+template void define_parallel_decomposition<storm::RationalNumber>(py::module& m, std::string const& vt_suffix);
+template void define_parallel_decomposition<storm::Interval>(py::module& m, std::string const& vt_suffix);
+template void define_parallel_decomposition<storm::RationalFunction>(py::module& m, std::string const& vt_suffix);
@@ -0,0 +1,8 @@
+#pragma once
+
+#include "common.h"
+
+void define_parallel_decomposition_result(py::module& m);
+
+template<typename ValueType>
+void define_parallel_decomposition(py::module& m, std::string const& vt_suffix);
@@ -0,0 +1,265 @@
+#include "prism_slicing.h"
+#include "src/helpers.h"
+
+#include "storm/storage/prism/Program.h"
+#include "storm/storage/jani/Property.h"
+#include "storm/storage/expressions/ExpressionManager.h"
+#include "storm/logic/Formula.h"
+#include "storm/utility/macros.h"
+#include "storm/exceptions/NotSupportedException.h"
+
+#include <algorithm>
+#include <optional>
+#include <set>
+#include <type_traits>
+
+using namespace storm::prism;
+
+struct PrismSlicingResult {
+    Program program;
+    std::vector<std::string> removedVariables;
+    uint64_t removedCommands = 0;
+    // Product of the domain sizes of all removed variables, i.e., an upper bound on the factor by which the state space shrinks
+    std::optional<double> stateSpaceReductionBound;
+};
+
+/*!
+ * Cone-of-influence slicing of a Prism program with respect to a set of properties.
+ * A variable is relevant if it occurs in a property, in a label or reward model used by a property, or if it influences
+ * a relevant variable. A command is relevant if it assigns a relevant variable, synchronizes on an action with such a
+ * command or carries action rewards. Relevant commands contribute the variables in their guard, their probabilities and
+ * their assignments to relevant variables.
+ * Irrelevant commands only loop on the relevant variables. For CTMCs, they are removed. For DTMCs and MDPs, their
+ * enabledness still influences the resolution of (non-)determinism, hence they are kept with a single empty update and
+ * their guard variables are relevant.
+ */
+class PrismProgramSlicer {
+public:
+    PrismProgramSlicer(Program const& originalProgram) : program(originalProgram.substituteConstantsFormulas()) {
+        auto type = program.getModelType();
+        STORM_LOG_THROW(type == Program::ModelType::DTMC || type == Program::ModelType::CTMC || type == Program::ModelType::MDP, storm::exceptions::NotSupportedException,
+                        "Slicing is only supported for DTMCs, CTMCs and MDPs.");
+        STORM_LOG_THROW(!program.hasInitialConstruct(), storm::exceptions::NotSupportedException, "Slicing programs with an init construct is not supported.");
+        for (auto const& variable : program.getGlobalBooleanVariables()) {
+            stateVariables.insert(variable.getExpressionVariable());
+        }
+        for (auto const& variable : program.getGlobalIntegerVariables()) {
+            stateVariables.insert(variable.getExpressionVariable());
+        }
+        for (auto const& module : program.getModules()) {
+            for (auto const& variable : module.getBooleanVariables()) {
+                stateVariables.insert(variable.getExpressionVariable());
+            }
+            for (auto const& variable : module.getIntegerVariables()) {
+                stateVariables.insert(variable.getExpressionVariable());
+            }
+        }
+    }
+
+    PrismSlicingResult slice(std::vector<storm::jani::Property> const& properties) {
+        std::vector<RewardModel> rewardModels;
+        for (auto const& property : properties) {
+            addRelevant(property.getUsedVariablesAndConstants());
+            for (auto const& label : property.getUsedLabels()) {
+                if (label == "init") {
+                    continue;
+                }
+                STORM_LOG_THROW(program.hasLabel(label), storm::exceptions::NotSupportedException, "Label '" << label << "' is not defined in the program and cannot be sliced.");
+                addRelevant(program.getLabelExpression(label).getVariables());
+            }
+            for (auto const& name : property.getRawFormula()->gatherReferencedRewardModels()) {
+                RewardModel const& rewardModel = getRewardModel(name);
+                if (std::none_of(rewardModels.begin(), rewardModels.end(), [&rewardModel](RewardModel const& r) { return r.getName() == rewardModel.getName(); })) {
+                    rewardModels.push_back(rewardModel);
+                }
+            }
+        }
+        for (auto const& rewardModel : rewardModels) {
+            addRewardModel(rewardModel);
+        }
+
+        // Compute the relevant variables and actions as fixpoint
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (auto const& module : program.getModules()) {
+                for (auto const& command : module.getCommands()) {
+                    if (isRelevant(command)) {
+                        changed |= addRelevant(command.getGuardExpression().getVariables());
+                        for (auto const& update : command.getUpdates()) {
+                            changed |= addRelevant(update.getLikelihoodExpression().getVariables());
+                            for (auto const& assignment : update.getAssignments()) {
+                                if (relevantVariables.count(assignment.getVariable()) > 0) {
+                                    changed |= addRelevant(assignment.getExpression().getVariables());
+                                }
+                            }
+                        }
+                        if (command.isLabeled()) {
+                            changed |= relevantActions.insert(command.getActionIndex()).second;
+                        }
+                    } else if (program.getModelType() != Program::ModelType::CTMC) {
+                        changed |= addRelevant(command.getGuardExpression().getVariables());
+                    }
+                }
+            }
+        }
+
+        PrismSlicingResult result{program, {}, 0, 1.0};
+        auto booleanVariables = filterVariables(program.getGlobalBooleanVariables(), result);
+        auto integerVariables = filterVariables(program.getGlobalIntegerVariables(), result);
+        std::vector<Module> modules;
+        uint64_t commandIndex = 0;
+        uint64_t updateIndex = 0;
+        for (auto const& module : program.getModules()) {
+            std::vector<Command> commands;
+            for (auto const& command : module.getCommands()) {
+                std::vector<Update> updates;
+                if (isRelevant(command)) {
+                    for (auto const& update : command.getUpdates()) {
+                        std::vector<Assignment> assignments;
+                        for (auto const& assignment : update.getAssignments()) {
+                            if (relevantVariables.count(assignment.getVariable()) > 0) {
+                                assignments.push_back(assignment);
+                            }
+                        }
+                        updates.emplace_back(updateIndex++, update.getLikelihoodExpression(), assignments, update.getFilename(), update.getLineNumber());
+                    }
+                } else if (program.getModelType() != Program::ModelType::CTMC) {
+                    updates.emplace_back(updateIndex++, program.getManager().rational(1.0), std::vector<Assignment>(), command.getFilename(), command.getLineNumber());
+                    ++result.removedCommands;
+                } else {
+                    ++result.removedCommands;
+                    continue;
+                }
+                commands.emplace_back(commandIndex++, command.isMarkovian(), command.getActionIndex(), command.getActionName(), command.getGuardExpression(), updates, command.getFilename(),
+                                      command.getLineNumber());
+            }
+            modules.emplace_back(module.getName(), filterVariables(module.getBooleanVariables(), result), filterVariables(module.getIntegerVariables(), result),
+                                 module.getClockVariables(), module.getInvariant(), commands, module.getFilename(), module.getLineNumber());
+        }
+
+        std::vector<Label> labels;
+        for (auto const& label : program.getLabels()) {
+            if (isRelevant(label.getStatePredicateExpression().getVariables())) {
+                labels.push_back(label);
+            }
+        }
+
+        result.program = Program(program.getManagerAsSharedPointer(), program.getModelType(), program.getConstants(), booleanVariables, integerVariables, std::vector<Formula>(),
+                                 program.getPlayers(), modules, program.getActionNameToIndexMapping(), rewardModels, labels, program.getObservationLabels(), boost::none,
+                                 program.getOptionalSystemCompositionConstruct(), false, program.getFilename(), program.getLineNumber());
+        return result;
+    }
+
+private:
+    Program program;
+    std::set<storm::expressions::Variable> stateVariables;
+    std::set<storm::expressions::Variable> relevantVariables;
+    std::set<uint_fast64_t> relevantActions;
+
+    // Adds all state variables among the given variables. Returns true if a new variable was added.
+    bool addRelevant(std::set<storm::expressions::Variable> const& variables) {
+        bool changed = false;
+        for (auto const& variable : variables) {
+            if (stateVariables.count(variable) > 0) {
+                changed |= relevantVariables.insert(variable).second;
+            }
+        }
+        return changed;
+    }
+
+    bool isRelevant(std::set<storm::expressions::Variable> const& variables) const {
+        return std::all_of(variables.begin(), variables.end(), [this](storm::expressions::Variable const& v) { return stateVariables.count(v) == 0 || relevantVariables.count(v) > 0; });
+    }
+
+    bool isRelevant(Command const& command) const {
+        if (relevantActions.count(command.getActionIndex()) > 0) {
+            return true;
+        }
+        for (auto const& update : command.getUpdates()) {
+            for (auto const& assignment : update.getAssignments()) {
+                if (relevantVariables.count(assignment.getVariable()) > 0) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    RewardModel const& getRewardModel(std::string const& name) const {
+        if (name.empty()) {
+            STORM_LOG_THROW(program.getNumberOfRewardModels() == 1, storm::exceptions::NotSupportedException, "Reference to the default reward model is ambiguous.");
+            return program.getRewardModel(0);
+        }
+        STORM_LOG_THROW(program.hasRewardModel(name), storm::exceptions::NotSupportedException, "Reward model '" << name << "' is not defined in the program.");
+        return program.getRewardModel(name);
+    }
+
+    void addRewardModel(RewardModel const& rewardModel) {
+        for (auto const& reward : rewardModel.getStateRewards()) {
+            addRelevant(reward.getStatePredicateExpression().getVariables());
+            addRelevant(reward.getRewardValueExpression().getVariables());
+        }
+        for (auto const& reward : rewardModel.getStateActionRewards()) {
+            relevantActions.insert(reward.getActionIndex());
+            addRelevant(reward.getStatePredicateExpression().getVariables());
+            addRelevant(reward.getRewardValueExpression().getVariables());
+        }
+        for (auto const& reward : rewardModel.getTransitionRewards()) {
+            relevantActions.insert(reward.getActionIndex());
+            addRelevant(reward.getSourceStatePredicateExpression().getVariables());
+            addRelevant(reward.getTargetStatePredicateExpression().getVariables());
+            addRelevant(reward.getRewardValueExpression().getVariables());
+        }
+    }
+
+    template<typename VariableType>
+    std::vector<VariableType> filterVariables(std::vector<VariableType> const& variables, PrismSlicingResult& result) const {
+        std::vector<VariableType> kept;
+        for (auto const& variable : variables) {
+            if (relevantVariables.count(variable.getExpressionVariable()) > 0) {
+                kept.push_back(variable);
+                continue;
+            }
+            result.removedVariables.push_back(variable.getName());
+            if (!result.stateSpaceReductionBound) {
+                continue;
+            }
+            if constexpr (std::is_same_v<VariableType, IntegerVariable>) {
+                if (variable.getLowerBoundExpression().containsVariables() || variable.getUpperBoundExpression().containsVariables()) {
+                    // Domain depends on undefined constants
+                    result.stateSpaceReductionBound = std::nullopt;
+                } else {
+                    *result.stateSpaceReductionBound *= variable.getUpperBoundExpression().evaluateAsInt() - variable.getLowerBoundExpression().evaluateAsInt() + 1;
+                }
+            } else {
+                *result.stateSpaceReductionBound *= 2;
+            }
+        }
+        return kept;
+    }
+};
+
+
+void define_prism_slicing(py::module& m) {
+    py::class_<PrismSlicingResult>(m, "PrismSlicingResult", "Result of slicing a Prism program")
+        .def_readonly("program", &PrismSlicingResult::program, "Sliced program")
+        .def_readonly("removed_variables", &PrismSlicingResult::removedVariables, "Names of the removed variables")
+        .def_readonly("nr_removed_commands", &PrismSlicingResult::removedCommands, "Number of commands which were removed or replaced by a command without assignments")
+        .def_readonly("state_space_reduction_bound", &PrismSlicingResult::stateSpaceReductionBound,
+                      "Product of the domain sizes of the removed variables, i.e., an upper bound on the factor by which the number of states is reduced. None if a domain depends on undefined constants.")
+    ;
+
+    m.def("slice_prism_program", [](Program const& program, std::vector<storm::jani::Property> const& properties) {
+            return PrismProgramSlicer(program).slice(properties);
+        }, py::arg("program"), py::arg("properties"), R"dox(
+
+        Remove variables and commands which do not influence the given properties (cone-of-influence slicing).
+        Constants and formulas are substituted beforehand.
+        Labels and reward models which are not used by the properties are removed as well.
+
+        :param PrismProgram program: The program to slice
+        :param List[Property] properties: Properties which must be preserved
+        :return: Slicing result containing the sliced program and the removed variables
+        )dox");
+}
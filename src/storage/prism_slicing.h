@@ -0,0 +1,5 @@
+#pragma once
+
+#include "common.h"
+
+void define_prism_slicing(py::module& m);
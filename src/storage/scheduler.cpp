@@ -1,8 +1,255 @@
 #include "scheduler.h"
 #include "src/helpers.h"
 
+#include "src/numpy_helpers.h"
+
 #include "storm/adapters/RationalFunctionAdapter.h"
+#include "storm/models/sparse/Mdp.h"
+#include "storm/models/sparse/StandardRewardModel.h"
+#include "storm/storage/BitVector.h"
+#include "storm/storage/Distribution.h"
 #include "storm/storage/Scheduler.h"
+#include "storm/utility/constants.h"
+#include "storm/utility/ConstantsComparator.h"
+#include "storm/utility/macros.h"
+#include "storm/utility/vector.h"
+#include "storm/exceptions/InvalidArgumentException.h"
+#include "storm/exceptions/InvalidOperationException.h"
+
+#include <cmath>
+#include <limits>
+#include <optional>
+
+using ChoiceArray = py::array_t<int64_t, py::array::c_style | py::array::forcecast>;
+using ProbabilityArray = py::array_t<double, py::array::c_style | py::array::forcecast>;
+
+template<typename ValueType>
+void checkMemoryless(storm::storage::Scheduler<ValueType> const& scheduler) {
+    STORM_LOG_THROW(scheduler.isMemorylessScheduler(), storm::exceptions::InvalidOperationException, "Only memoryless schedulers can be exported as arrays.");
+}
+
+// Local choice index per state, -1 for undefined choices
+template<typename ValueType>
+py::array_t<int64_t> schedulerToChoiceArray(storm::storage::Scheduler<ValueType> const& scheduler) {
+    checkMemoryless(scheduler);
+    STORM_LOG_THROW(scheduler.isDeterministicScheduler(), storm::exceptions::InvalidOperationException, "Scheduler is randomized, export it as distributions instead.");
+    py::array_t<int64_t> result(scheduler.getNumberOfModelStates());
+    auto choices = result.mutable_unchecked<1>();
+    for (uint64_t state = 0; state < scheduler.getNumberOfModelStates(); ++state) {
+        auto const& choice = scheduler.getChoice(state);
+        choices(state) = choice.isDefined() ? static_cast<int64_t>(choice.getDeterministicChoice()) : -1;
+    }
+    return result;
+}
+
+template<typename ValueType>
+storm::storage::Scheduler<ValueType> schedulerFromChoiceArray(ChoiceArray const& choices) {
+    STORM_LOG_THROW(choices.ndim() == 1, storm::exceptions::InvalidArgumentException, "Expected one-dimensional array.");
+    storm::storage::Scheduler<ValueType> scheduler(choices.size());
+    auto data = choices.unchecked<1>();
+    for (py::ssize_t state = 0; state < data.shape(0); ++state) {
+        if (data(state) >= 0) {
+            scheduler.setChoice(storm::storage::SchedulerChoice<ValueType>(data(state)), state);
+        }
+    }
+    return scheduler;
+}
+
+// Distributions in CSR format: the choices of state s are at positions offsets[s] to offsets[s+1]
+py::tuple schedulerToDistributionArrays(storm::storage::Scheduler<double> const& scheduler) {
+    checkMemoryless(scheduler);
+    std::vector<uint64_t> offsets = {0};
+    std::vector<uint64_t> choices;
+    std::vector<double> probabilities;
+    for (uint64_t state = 0; state < scheduler.getNumberOfModelStates(); ++state) {
+        auto const& choice = scheduler.getChoice(state);
+        if (choice.isDefined()) {
+            for (auto const& entry : choice.getChoiceAsDistribution()) {
+                choices.push_back(entry.first);
+                probabilities.push_back(entry.second);
+            }
+        }
+        offsets.push_back(choices.size());
+    }
+    return py::make_tuple(py::array_t<uint64_t>(offsets.size(), offsets.data()), py::array_t<uint64_t>(choices.size(), choices.data()),
+                          py::array_t<double>(probabilities.size(), probabilities.data()));
+}
+
+storm::storage::Scheduler<double> schedulerFromDistributionArrays(ChoiceArray const& offsets, ChoiceArray const& choices, ProbabilityArray const& probabilities) {
+    STORM_LOG_THROW(offsets.ndim() == 1 && offsets.size() > 0, storm::exceptions::InvalidArgumentException, "Expected non-empty one-dimensional array of offsets.");
+    STORM_LOG_THROW(choices.ndim() == 1 && probabilities.ndim() == 1 && choices.size() == probabilities.size(), storm::exceptions::InvalidArgumentException,
+                    "Choices and probabilities must be one-dimensional arrays of the same size.");
+    auto offsetData = offsets.unchecked<1>();
+    auto choiceData = choices.unchecked<1>();
+    auto probabilityData = probabilities.unchecked<1>();
+    STORM_LOG_THROW(offsetData(0) == 0 && offsetData(offsets.size() - 1) == choices.size(), storm::exceptions::InvalidArgumentException, "Offsets do not match the number of choices.");
+    storm::storage::Scheduler<double> scheduler(offsets.size() - 1);
+    storm::utility::ConstantsComparator<double> comparator;
+    for (py::ssize_t state = 0; state + 1 < offsets.size(); ++state) {
+        STORM_LOG_THROW(offsetData(state) <= offsetData(state + 1), storm::exceptions::InvalidArgumentException, "Offsets must be non-decreasing.");
+        if (offsetData(state) == offsetData(state + 1)) {
+            continue;
+        }
+        storm::storage::Distribution<double, uint_fast64_t> distribution;
+        double sum = 0;
+        for (int64_t i = offsetData(state); i < offsetData(state + 1); ++i) {
+            STORM_LOG_THROW(choiceData(i) >= 0, storm::exceptions::InvalidArgumentException, "Choices must be non-negative.");
+            STORM_LOG_THROW(probabilityData(i) >= 0, storm::exceptions::InvalidArgumentException, "Probability " << probabilityData(i) << " of state " << state << " is negative.");
+            distribution.addProbability(choiceData(i), probabilityData(i));
+            sum += probabilityData(i);
+        }
+        STORM_LOG_THROW(comparator.isOne(sum), storm::exceptions::InvalidArgumentException, "Probabilities of state " << state << " sum up to " << sum << " instead of 1.");
+        scheduler.setChoice(storm::storage::SchedulerChoice<double>(distribution), state);
+    }
+    return scheduler;
+}
+
+/*!
+ * DTMC induced by a memoryless deterministic scheduler on an MDP.
+ * The transitions are read from the selected rows of the MDP matrix, hence no new model is built.
+ * States where the scheduler is undefined take their first choice.
+ */
+class InducedDtmc {
+public:
+    InducedDtmc(std::shared_ptr<storm::models::sparse::Mdp<double>> mdp, std::vector<int64_t> const& localChoices) : mdp(mdp), rows(mdp->getNumberOfStates()) {
+        STORM_LOG_THROW(localChoices.size() == mdp->getNumberOfStates(), storm::exceptions::InvalidArgumentException,
+                        "Expected " << mdp->getNumberOfStates() << " choices but got " << localChoices.size() << ".");
+        auto const& groups = mdp->getNondeterministicChoiceIndices();
+        for (uint64_t state = 0; state < rows.size(); ++state) {
+            uint64_t choice = localChoices[state] < 0 ? 0 : localChoices[state];
+            STORM_LOG_THROW(groups[state] + choice < groups[state + 1], storm::exceptions::InvalidArgumentException, "Choice " << choice << " is not available in state " << state << ".");
+            rows[state] = groups[state] + choice;
+        }
+        computePredecessors();
+    }
+
+    uint64_t getNumberOfStates() const {
+        return rows.size();
+    }
+
+    std::vector<uint64_t> const& getRows() const {
+        return rows;
+    }
+
+    storm::storage::SparseMatrix<double> getTransitionMatrix() const {
+        auto const& groups = mdp->getNondeterministicChoiceIndices();
+        std::vector<uint_fast64_t> localChoices(rows.size());
+        for (uint64_t state = 0; state < rows.size(); ++state) {
+            localChoices[state] = rows[state] - groups[state];
+        }
+        return mdp->getTransitionMatrix().selectRowsFromRowGroups(localChoices, false);
+    }
+
+    std::vector<double> multiply(std::vector<double> const& vector) const {
+        STORM_LOG_THROW(vector.size() == rows.size(), storm::exceptions::InvalidArgumentException, "Vector has wrong size.");
+        std::vector<double> result(rows.size());
+        for (uint64_t state = 0; state < rows.size(); ++state) {
+            result[state] = mdp->getTransitionMatrix().multiplyRowWithVector(rows[state], vector);
+        }
+        return result;
+    }
+
+    std::vector<double> computeReachabilityProbabilities(storm::storage::BitVector const& target, double precision, uint64_t maxIterations) const {
+        checkTarget(target);
+        std::vector<double> result(rows.size(), storm::utility::zero<double>());
+        storm::utility::vector::setVectorValues(result, target, storm::utility::one<double>());
+        storm::storage::BitVector maybe = backwardReachable(target, ~target) & ~target;
+        solve(result, maybe, std::vector<double>(rows.size(), storm::utility::zero<double>()), precision, maxIterations);
+        return result;
+    }
+
+    std::vector<double> computeExpectedRewards(std::string const& rewardModelName, storm::storage::BitVector const& target, double precision, uint64_t maxIterations) const {
+        checkTarget(target);
+        auto const& rewardModel = rewardModelName.empty() ? mdp->getUniqueRewardModel() : mdp->getRewardModel(rewardModelName);
+        // States reaching the target with probability < 1 have infinite reward
+        storm::storage::BitVector reachTarget = backwardReachable(target, ~target);
+        storm::storage::BitVector notAlmostSure = backwardReachable(~reachTarget, ~target);
+        std::vector<double> result(rows.size(), storm::utility::zero<double>());
+        storm::utility::vector::setVectorValues(result, notAlmostSure, storm::utility::infinity<double>());
+        std::vector<double> rewards(rows.size(), storm::utility::zero<double>());
+        for (uint64_t state = 0; state < rows.size(); ++state) {
+            rewards[state] = rewardModel.getTotalStateActionReward(state, rows[state], mdp->getTransitionMatrix());
+        }
+        solve(result, ~notAlmostSure & ~target, rewards, precision, maxIterations);
+        return result;
+    }
+
+private:
+    std::shared_ptr<storm::models::sparse::Mdp<double>> mdp;
+    // Selected row of the MDP matrix for each state
+    std::vector<uint64_t> rows;
+    // Predecessor relation in CSR format. It is computed in the constructor such that concurrent queries (without the GIL) only read it.
+    std::vector<uint64_t> predecessorOffsets;
+    std::vector<uint64_t> predecessors;
+
+    void checkTarget(storm::storage::BitVector const& target) const {
+        STORM_LOG_THROW(target.size() == rows.size(), storm::exceptions::InvalidArgumentException, "Target states have wrong size.");
+    }
+
+    void computePredecessors() {
+        auto const& matrix = mdp->getTransitionMatrix();
+        predecessorOffsets.assign(rows.size() + 1, 0);
+        for (uint64_t row : rows) {
+            for (auto const& entry : matrix.getRow(row)) {
+                if (!storm::utility::isZero(entry.getValue())) {
+                    ++predecessorOffsets[entry.getColumn() + 1];
+                }
+            }
+        }
+        for (uint64_t state = 0; state < rows.size(); ++state) {
+            predecessorOffsets[state + 1] += predecessorOffsets[state];
+        }
+        predecessors.resize(predecessorOffsets.back());
+        std::vector<uint64_t> position(predecessorOffsets.begin(), predecessorOffsets.end() - 1);
+        for (uint64_t state = 0; state < rows.size(); ++state) {
+            for (auto const& entry : matrix.getRow(rows[state])) {
+                if (!storm::utility::isZero(entry.getValue())) {
+                    predecessors[position[entry.getColumn()]++] = state;
+                }
+            }
+        }
+    }
+
+    // States which can reach the start states by only visiting allowed states in between
+    storm::storage::BitVector backwardReachable(storm::storage::BitVector const& start, storm::storage::BitVector const& allowed) const {
+        storm::storage::BitVector reached = start;
+        std::vector<uint64_t> stack(start.begin(), start.end());
+        while (!stack.empty()) {
+            uint64_t state = stack.back();
+            stack.pop_back();
+            for (uint64_t i = predecessorOffsets[state]; i < predecessorOffsets[state + 1]; ++i) {
+                uint64_t predecessor = predecessors[i];
+                if (allowed.get(predecessor) && !reached.get(predecessor)) {
+                    reached.set(predecessor);
+                    stack.push_back(predecessor);
+                }
+            }
+        }
+        return reached;
+    }
+
+    // Gauss-Seidel iteration x = b + P x on the given states
+    void solve(std::vector<double>& x, storm::storage::BitVector const& states, std::vector<double> const& b, double precision, uint64_t maxIterations) const {
+        auto const& matrix = mdp->getTransitionMatrix();
+        for (uint64_t iteration = 0; iteration < maxIterations; ++iteration) {
+            double difference = 0;
+            for (uint64_t state : states) {
+                double value = b[state] + matrix.multiplyRowWithVector(rows[state], x);
+                difference = std::max(difference, std::abs(value - x[state]));
+                x[state] = value;
+            }
+            if (difference <= precision) {
+                return;
+            }
+        }
+        STORM_LOG_WARN("Iteration did not converge within " << maxIterations << " iterations.");
+    }
+};
+
+std::vector<int64_t> toLocalChoices(storm::storage::Scheduler<double> const& scheduler) {
+    auto array = schedulerToChoiceArray(scheduler);
+    return std::vector<int64_t>(array.data(), array.data() + array.size());
+}
 
 template<typename ValueType>
 void define_scheduler(py::module& m, std::string vt_suffix) {
@@ -30,8 +277,36 @@ void define_scheduler(py::module& m, std::string vt_suffix) {
                     s.printJsonToStream(str, model, skipUniqueChoices, skipDontCareStates);
                     return str.str();
                 }, py::arg("model"), py::arg("skip_unique_choices") = false, py::arg("skip_dont_care_states") = false)
+            .def("to_choice_array", &schedulerToChoiceArray<ValueType>, "Export a memoryless deterministic scheduler as NumPy array containing the (local) choice index for each state, or -1 if the choice is undefined")
+            .def_static("from_choice_array", &schedulerFromChoiceArray<ValueType>, py::arg("choices"), R"dox(
+
+            Create a memoryless deterministic scheduler from an array of choices.
+
+            :param choices: Array containing the (local) choice index for each state. Negative values leave the choice undefined.
+            :return: Scheduler
+            )dox")
     ;
 
+    if constexpr (std::is_same_v<ValueType, double>) {
+        scheduler
+            .def("to_distribution_arrays", &schedulerToDistributionArrays, R"dox(
+
+            Export a memoryless (possibly randomized) scheduler as distributions in CSR format.
+
+            :return: Tuple (offsets, choices, probabilities) of NumPy arrays. The distribution of state s is given by the (local) choices and probabilities at positions offsets[s] to offsets[s+1].
+            )dox")
+            .def_static("from_distribution_arrays", &schedulerFromDistributionArrays, py::arg("offsets"), py::arg("choices"), py::arg("probabilities"), R"dox(
+
+            Create a memoryless randomized scheduler from distributions in CSR format.
+
+            :param offsets: Array with nr_states+1 entries, the distribution of state s is given by positions offsets[s] to offsets[s+1]
+            :param choices: Array containing the (local) choice indices
+            :param probabilities: Array containing the probability of each choice. Probabilities must be non-negative and sum up to 1 for each state.
+            :return: Scheduler
+            )dox")
+        ;
+    }
+
     if constexpr (!std::is_same_v<ValueType, storm::Interval>) {
         // Conversion from Interval not implemented
         scheduler
@@ -57,6 +332,42 @@ void define_scheduler(py::module& m, std::string vt_suffix) {
         .def("__str__", &streamToString<SchedulerChoice>);
 }
 
+void define_induced_dtmc(py::module& m) {
+    py::class_<InducedDtmc>(m, "InducedDtmc", "DTMC induced by a memoryless deterministic scheduler on an MDP, evaluated on the MDP without building a new model")
+        .def(py::init([](std::shared_ptr<storm::models::sparse::Mdp<double>> mdp, storm::storage::Scheduler<double> const& scheduler) {
+                return InducedDtmc(mdp, toLocalChoices(scheduler));
+            }), py::arg("mdp"), py::arg("scheduler"))
+        .def(py::init([](std::shared_ptr<storm::models::sparse::Mdp<double>> mdp, ChoiceArray const& choices) {
+                STORM_LOG_THROW(choices.ndim() == 1, storm::exceptions::InvalidArgumentException, "Expected one-dimensional array.");
+                return InducedDtmc(mdp, std::vector<int64_t>(choices.data(), choices.data() + choices.size()));
+            }), py::arg("mdp"), py::arg("choices"))
+        .def_property_readonly("nr_states", &InducedDtmc::getNumberOfStates, "Number of states")
+        .def_property_readonly("rows", [](py::object const& self) { return vectorAsNumpy(self.cast<InducedDtmc const&>().getRows(), self); }, "Selected row of the MDP matrix for each state")
+        .def_property_readonly("transition_matrix", &InducedDtmc::getTransitionMatrix, "Build the transition matrix of the induced DTMC")
+        .def("multiply", &InducedDtmc::multiply, py::arg("vector"), py::call_guard<py::gil_scoped_release>(), "Multiply the transition matrix with a vector")
+        .def("compute_reachability_probabilities", &InducedDtmc::computeReachabilityProbabilities, py::arg("target"), py::arg("precision") = 1e-6,
+             py::arg("maximal_iterations") = std::numeric_limits<uint64_t>::max(), py::call_guard<py::gil_scoped_release>(), R"dox(
+
+            Compute the probabilities to reach the target states by value iteration.
+
+            :param BitVector target: Target states
+            :param double precision: Precision (absolute difference between iterations) for convergence
+            :param int maximal_iterations: Maximal number of iterations
+            :return: Probability for each state
+            )dox")
+        .def("compute_expected_rewards", &InducedDtmc::computeExpectedRewards, py::arg("reward_model"), py::arg("target"), py::arg("precision") = 1e-6,
+             py::arg("maximal_iterations") = std::numeric_limits<uint64_t>::max(), py::call_guard<py::gil_scoped_release>(), R"dox(
+
+            Compute the expected rewards until reaching the target states by value iteration.
+
+            :param str reward_model: Name of the reward model, empty string for the unique reward model
+            :param BitVector target: Target states
+            :param double precision: Precision (absolute difference between iterations) for convergence
+            :param int maximal_iterations: Maximal number of iterations
+            :return: Expected reward for each state, infinity if the target is not reached almost surely
+            )dox")
+    ;
+}
 
 template void define_scheduler<double>(py::module& m, std::string vt_suffix);
 template void define_scheduler<storm::RationalNumber>(py::module& m, std::string vt_suffix);
@@ -5,3 +5,5 @@
 
 template<typename ValueType>
 void define_scheduler(py::module& m, std::string vt_suffix);
+
+void define_induced_dtmc(py::module& m);
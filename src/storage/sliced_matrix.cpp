@@ -0,0 +1,595 @@
+#include "sliced_matrix.h"
+#include "src/helpers.h"
+
+#include "storm/storage/SparseMatrix.h"
+#include "storm/solver/OptimizationDirection.h"
+#include "storm/utility/macros.h"
+#include "storm/exceptions/InvalidArgumentException.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <type_traits>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+template<typename ValueType> using SparseMatrix = storm::storage::SparseMatrix<ValueType>;
+
+// Number of rows in one slice. Matches the number of values processed by one vector instruction.
+template<typename ValueType>
+struct SliceHeight {
+    static constexpr uint64_t value = 4;
+};
+
+template<>
+struct SliceHeight<float> {
+#if defined(__AVX512F__)
+    static constexpr uint64_t value = 16;
+#else
+    static constexpr uint64_t value = 8;
+#endif
+};
+
+#if defined(__AVX512F__)
+template<>
+struct SliceHeight<double> {
+    static constexpr uint64_t value = 8;
+};
+#endif
+
+// Computes the scalar products of all rows of one slice with the vector x.
+// Entries of a slice are stored column-major, i.e., the j-th entries of all rows are consecutive.
+template<typename ValueType, typename IndexType>
+void multiplySlice(IndexType const* columns, ValueType const* values, uint64_t width, ValueType const* x, ValueType* sums) {
+    constexpr uint64_t height = SliceHeight<ValueType>::value;
+    for (uint64_t row = 0; row < height; ++row) {
+        sums[row] = ValueType(0);
+    }
+    for (uint64_t j = 0; j < width; ++j) {
+        for (uint64_t row = 0; row < height; ++row) {
+            sums[row] += values[row] * x[columns[row]];
+        }
+        columns += height;
+        values += height;
+    }
+}
+
+#if defined(__AVX512F__)
+inline void multiplySlice(uint32_t const* columns, double const* values, uint64_t width, double const* x, double* sums) {
+    __m512d acc = _mm512_setzero_pd();
+    for (uint64_t j = 0; j < width; ++j) {
+        __m256i indices = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(columns));
+        __m512d gathered = _mm512_i32gather_pd(indices, x, sizeof(double));
+        acc = _mm512_fmadd_pd(_mm512_loadu_pd(values), gathered, acc);
+        columns += 8;
+        values += 8;
+    }
+    _mm512_storeu_pd(sums, acc);
+}
+
+inline void multiplySlice(uint64_t const* columns, double const* values, uint64_t width, double const* x, double* sums) {
+    __m512d acc = _mm512_setzero_pd();
+    for (uint64_t j = 0; j < width; ++j) {
+        __m512i indices = _mm512_loadu_si512(reinterpret_cast<void const*>(columns));
+        __m512d gathered = _mm512_i64gather_pd(indices, x, sizeof(double));
+        acc = _mm512_fmadd_pd(_mm512_loadu_pd(values), gathered, acc);
+        columns += 8;
+        values += 8;
+    }
+    _mm512_storeu_pd(sums, acc);
+}
+
+inline void multiplySlice(uint32_t const* columns, float const* values, uint64_t width, float const* x, float* sums) {
+    __m512 acc = _mm512_setzero_ps();
+    for (uint64_t j = 0; j < width; ++j) {
+        __m512i indices = _mm512_loadu_si512(reinterpret_cast<void const*>(columns));
+        __m512 gathered = _mm512_i32gather_ps(indices, x, sizeof(float));
+        acc = _mm512_fmadd_ps(_mm512_loadu_ps(values), gathered, acc);
+        columns += 16;
+        values += 16;
+    }
+    _mm512_storeu_ps(sums, acc);
+}
+#elif defined(__AVX2__)
+inline void multiplySlice(uint32_t const* columns, double const* values, uint64_t width, double const* x, double* sums) {
+    __m256d acc = _mm256_setzero_pd();
+    for (uint64_t j = 0; j < width; ++j) {
+        __m128i indices = _mm_loadu_si128(reinterpret_cast<__m128i const*>(columns));
+        __m256d gathered = _mm256_i32gather_pd(x, indices, sizeof(double));
+#if defined(__FMA__)
+        acc = _mm256_fmadd_pd(_mm256_loadu_pd(values), gathered, acc);
+#else
+        acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_loadu_pd(values), gathered));
+#endif
+        columns += 4;
+        values += 4;
+    }
+    _mm256_storeu_pd(sums, acc);
+}
+
+inline void multiplySlice(uint64_t const* columns, double const* values, uint64_t width, double const* x, double* sums) {
+    __m256d acc = _mm256_setzero_pd();
+    for (uint64_t j = 0; j < width; ++j) {
+        __m256i indices = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(columns));
+        __m256d gathered = _mm256_i64gather_pd(x, indices, sizeof(double));
+#if defined(__FMA__)
+        acc = _mm256_fmadd_pd(_mm256_loadu_pd(values), gathered, acc);
+#else
+        acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_loadu_pd(values), gathered));
+#endif
+        columns += 4;
+        values += 4;
+    }
+    _mm256_storeu_pd(sums, acc);
+}
+
+inline void multiplySlice(uint32_t const* columns, float const* values, uint64_t width, float const* x, float* sums) {
+    __m256 acc = _mm256_setzero_ps();
+    for (uint64_t j = 0; j < width; ++j) {
+        __m256i indices = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(columns));
+        __m256 gathered = _mm256_i32gather_ps(x, indices, sizeof(float));
+#if defined(__FMA__)
+        acc = _mm256_fmadd_ps(_mm256_loadu_ps(values), gathered, acc);
+#else
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(values), gathered));
+#endif
+        columns += 8;
+        values += 8;
+    }
+    _mm256_storeu_ps(sums, acc);
+}
+#endif
+
+// Largest difference between two vectors (absolute or relative to the entries of the first vector).
+template<typename ValueType>
+ValueType maximalDifference(std::vector<ValueType> const& first, std::vector<ValueType> const& second, bool relative) {
+    ValueType result = ValueType(0);
+    for (uint64_t i = 0; i < first.size(); ++i) {
+        ValueType difference = std::abs(first[i] - second[i]);
+        if (relative && first[i] != ValueType(0)) {
+            difference /= std::abs(first[i]);
+        }
+        result = std::max(result, difference);
+    }
+    return result;
+}
+
+template<typename ValueType>
+struct SlicedSolverResult {
+    std::vector<ValueType> values;
+    uint64_t iterations = 0;
+    bool converged = false;
+    // Difference between the last two iterates
+    ValueType lastDifference = std::numeric_limits<ValueType>::infinity();
+};
+
+struct MixedPrecisionSolverResult {
+    // Midpoint of the lower and upper bounds
+    std::vector<double> values;
+    std::vector<double> lowerValues;
+    std::vector<double> upperValues;
+    uint64_t approximateIterations = 0;
+    uint64_t refinementIterations = 0;
+    // Largest difference between the upper and lower bounds (relative to the lower bound if requested)
+    double errorBound = std::numeric_limits<double>::infinity();
+    // Flag whether the error bound is at most the precision
+    bool certified = false;
+};
+
+/*!
+ * Sparse matrix with row groups in the sliced ELLPACK (SELL-C-sigma) format.
+ * Rows are packed into slices of C rows. Within a slice, the entries are stored column-major and padded with zeros to
+ * the length of the longest row in the slice. To keep the padding small, rows are sorted by their length within
+ * windows of sigma rows. Column, row and row group indices are stored with the given index type, which allows to
+ * halve the memory for indices compared to the 64-bit indices of SparseMatrix.
+ * The values can be stored with a smaller precision than in the original matrix, e.g., as float.
+ */
+template<typename ValueType, typename IndexType>
+class SlicedMatrix {
+public:
+    typedef IndexType index_type;
+    static constexpr uint64_t sliceHeight = SliceHeight<ValueType>::value;
+
+    // Largest row or column count which can be represented. Vector gathers interpret indices as signed integers.
+    static constexpr uint64_t maxIndex = std::numeric_limits<std::make_signed_t<IndexType>>::max();
+
+    /*!
+     * Checks whether a sparse matrix fits into the index range of this representation.
+     */
+    template<typename SourceValueType>
+    static bool fits(SparseMatrix<SourceValueType> const& matrix) {
+        return matrix.getRowCount() <= maxIndex && matrix.getColumnCount() <= maxIndex;
+    }
+
+    template<typename SourceValueType>
+    SlicedMatrix(SparseMatrix<SourceValueType> const& matrix, uint64_t sortingScope) : rowCount(matrix.getRowCount()), columnCount(matrix.getColumnCount()), entryCount(matrix.getEntryCount()) {
+        STORM_LOG_THROW(fits(matrix), storm::exceptions::InvalidArgumentException, "Matrix with " << rowCount << " rows and " << columnCount << " columns exceeds the " << 8 * sizeof(IndexType) << "-bit index range of the sliced representation.");
+        STORM_LOG_THROW(sortingScope > 0, storm::exceptions::InvalidArgumentException, "Sorting scope must be positive.");
+
+        auto const& groups = matrix.getRowGroupIndices();
+        rowGroupIndices.reserve(groups.size());
+        for (auto index : groups) {
+            rowGroupIndices.push_back(static_cast<index_type>(index));
+        }
+
+        std::vector<index_type> rowLengths(rowCount);
+        for (uint64_t row = 0; row < rowCount; ++row) {
+            rowLengths[row] = static_cast<index_type>(matrix.getRow(row).getNumberOfEntries());
+        }
+
+        // Sort rows by decreasing length within each window of the sorting scope
+        uint64_t sliceCount = (rowCount + sliceHeight - 1) / sliceHeight;
+        rowOrder.resize(rowCount);
+        std::iota(rowOrder.begin(), rowOrder.end(), 0);
+        for (uint64_t start = 0; start < rowCount; start += sortingScope) {
+            uint64_t end = std::min(start + sortingScope, rowCount);
+            std::stable_sort(rowOrder.begin() + start, rowOrder.begin() + end, [&rowLengths](index_type a, index_type b) { return rowLengths[a] > rowLengths[b]; });
+        }
+
+        // Compute slice offsets
+        sliceOffsets.reserve(sliceCount + 1);
+        sliceOffsets.push_back(0);
+        for (uint64_t slice = 0; slice < sliceCount; ++slice) {
+            index_type width = 0;
+            for (uint64_t pos = slice * sliceHeight; pos < std::min((slice + 1) * sliceHeight, rowCount); ++pos) {
+                width = std::max(width, rowLengths[rowOrder[pos]]);
+            }
+            sliceOffsets.push_back(sliceOffsets.back() + width * sliceHeight);
+        }
+
+        // Fill slices. Padding entries point to column 0 and have value 0.
+        columns.assign(sliceOffsets.back(), 0);
+        values.assign(sliceOffsets.back(), ValueType(0));
+        for (uint64_t pos = 0; pos < rowCount; ++pos) {
+            uint64_t offset = sliceOffsets[pos / sliceHeight] + pos % sliceHeight;
+            for (auto const& entry : matrix.getRow(rowOrder[pos])) {
+                columns[offset] = static_cast<index_type>(entry.getColumn());
+                values[offset] = static_cast<ValueType>(entry.getValue());
+                offset += sliceHeight;
+            }
+        }
+    }
+
+    uint64_t getRowCount() const {
+        return rowCount;
+    }
+
+    uint64_t getColumnCount() const {
+        return columnCount;
+    }
+
+    uint64_t getEntryCount() const {
+        return entryCount;
+    }
+
+    uint64_t getRowGroupCount() const {
+        return rowGroupIndices.size() - 1;
+    }
+
+    uint64_t getPaddedEntryCount() const {
+        return values.size();
+    }
+
+    uint64_t getSizeInMemory() const {
+        return sizeof(*this) + sizeof(index_type) * (columns.capacity() + rowOrder.capacity() + rowGroupIndices.capacity())
+               + sizeof(ValueType) * values.capacity() + sizeof(uint64_t) * sliceOffsets.capacity();
+    }
+
+    /*!
+     * Multiplies the matrix with the vector x and adds the summand (if given).
+     * The result contains one entry per row.
+     */
+    void multiply(std::vector<ValueType> const& x, std::vector<ValueType> const* summand, std::vector<ValueType>& result) const {
+        STORM_LOG_THROW(x.size() >= columnCount, storm::exceptions::InvalidArgumentException, "Vector has " << x.size() << " entries but the matrix has " << columnCount << " columns.");
+        STORM_LOG_THROW(summand == nullptr || summand->size() >= rowCount, storm::exceptions::InvalidArgumentException, "Summand has " << summand->size() << " entries but the matrix has " << rowCount << " rows.");
+        result.resize(rowCount);
+        std::array<ValueType, sliceHeight> sums;
+        for (uint64_t slice = 0; slice + 1 < sliceOffsets.size(); ++slice) {
+            uint64_t offset = sliceOffsets[slice];
+            multiplySlice(columns.data() + offset, values.data() + offset, (sliceOffsets[slice + 1] - offset) / sliceHeight, x.data(), sums.data());
+            uint64_t firstPos = slice * sliceHeight;
+            uint64_t rowsInSlice = std::min(sliceHeight, rowCount - firstPos);
+            for (uint64_t i = 0; i < rowsInSlice; ++i) {
+                index_type row = rowOrder[firstPos + i];
+                result[row] = summand == nullptr ? sums[i] : sums[i] + (*summand)[row];
+            }
+        }
+    }
+
+    /*!
+     * Multiplies the matrix with the vector x, adds the summand (if given) and reduces each row group to its minimum
+     * or maximum. The row results are stored in rowResult, the reduced values in result.
+     * If choices is given, it is filled with the offset of the optimal row within each row group.
+     */
+    void multiplyAndReduce(storm::solver::OptimizationDirection dir, std::vector<ValueType> const& x, std::vector<ValueType> const* summand, std::vector<ValueType>& rowResult,
+                           std::vector<ValueType>& result, std::vector<uint64_t>* choices) const {
+        multiply(x, summand, rowResult);
+        uint64_t groupCount = getRowGroupCount();
+        result.resize(groupCount);
+        if (choices != nullptr) {
+            choices->resize(groupCount);
+        }
+        bool minimize = storm::solver::minimize(dir);
+        for (uint64_t group = 0; group < groupCount; ++group) {
+            index_type first = rowGroupIndices[group];
+            index_type last = rowGroupIndices[group + 1];
+            if (first == last) {
+                result[group] = ValueType(0);
+                if (choices != nullptr) {
+                    (*choices)[group] = 0;
+                }
+                continue;
+            }
+            index_type best = first;
+            for (index_type row = first + 1; row < last; ++row) {
+                if (minimize ? rowResult[row] < rowResult[best] : rowResult[row] > rowResult[best]) {
+                    best = row;
+                }
+            }
+            result[group] = rowResult[best];
+            if (choices != nullptr) {
+                (*choices)[group] = best - first;
+            }
+        }
+    }
+
+    /*!
+     * Solves x = min/max (A*x + b) by value iteration, starting from the given initial values.
+     * Iterates until two consecutive iterates differ by at most the precision or the maximal number of iterations is reached.
+     */
+    SlicedSolverResult<ValueType> solveMinMaxEquations(storm::solver::OptimizationDirection dir, std::vector<ValueType> const& b, std::vector<ValueType> x, ValueType precision, bool relative, uint64_t maxIterations) const {
+        STORM_LOG_THROW(columnCount == getRowGroupCount(), storm::exceptions::InvalidArgumentException, "Equation system requires as many columns as row groups.");
+        STORM_LOG_THROW(b.size() == rowCount, storm::exceptions::InvalidArgumentException, "Summand needs one entry per row.");
+        STORM_LOG_THROW(x.size() == columnCount, storm::exceptions::InvalidArgumentException, "Initial values need one entry per row group.");
+        SlicedSolverResult<ValueType> result;
+        std::vector<ValueType> rowResult(rowCount);
+        std::vector<ValueType> next(x.size());
+        while (result.iterations < maxIterations) {
+            multiplyAndReduce(dir, x, &b, rowResult, next, nullptr);
+            ++result.iterations;
+            result.lastDifference = maximalDifference(x, next, relative);
+            result.converged = result.lastDifference <= precision;
+            std::swap(x, next);
+            if (result.converged) {
+                break;
+            }
+        }
+        result.values = std::move(x);
+        return result;
+    }
+
+private:
+    uint64_t rowCount;
+    uint64_t columnCount;
+    uint64_t entryCount;
+    // Start of each slice in columns and values
+    std::vector<uint64_t> sliceOffsets;
+    std::vector<index_type> columns;
+    std::vector<ValueType> values;
+    // Original row index of the i-th row in the sliced layout
+    std::vector<index_type> rowOrder;
+    std::vector<index_type> rowGroupIndices;
+};
+
+// Clamps the vector to the given bounds.
+inline void clampToBounds(std::vector<double>& x, std::vector<double> const& lower, std::vector<double> const& upper) {
+    for (uint64_t i = 0; i < x.size(); ++i) {
+        x[i] = std::min(std::max(x[i], lower[i]), upper[i]);
+    }
+}
+
+/*!
+ * Solves x = min/max (A*x + b) in two phases. First, value iteration is performed in single precision on a sliced copy
+ * of the matrix until the approximate precision is reached. Afterwards, the result is refined in double precision on
+ * the original matrix by interval iteration, which maintains a lower and an upper bound on the solution.
+ * The single precision result is used as a warm start for the bounds if it passes the corresponding check (F(u) <= u for
+ * the upper bound and l <= F(l) for the lower bound), otherwise the given bounds are used.
+ * The bounds are sound if the given bounds enclose the solution and the solution is the unique fixed point within
+ * these bounds (e.g., after removing end components or fixing the values of states in end components by the bounds).
+ */
+template<typename IndexType>
+MixedPrecisionSolverResult solveMinMaxEquationsMixedPrecision(SparseMatrix<double> const& matrix, storm::solver::OptimizationDirection dir, std::vector<double> const& b, std::vector<double> const& x,
+                                                              std::vector<double> const& lowerBounds, std::vector<double> const& upperBounds, double precision, double approximatePrecision,
+                                                              bool relative, uint64_t maxIterations, uint64_t sortingScope) {
+    STORM_LOG_THROW(matrix.getColumnCount() == matrix.getRowGroupCount(), storm::exceptions::InvalidArgumentException, "Equation system requires as many columns as row groups.");
+    STORM_LOG_THROW(b.size() == matrix.getRowCount(), storm::exceptions::InvalidArgumentException, "Summand needs one entry per row.");
+    STORM_LOG_THROW(x.size() == matrix.getColumnCount(), storm::exceptions::InvalidArgumentException, "Initial values need one entry per row group.");
+    STORM_LOG_THROW(lowerBounds.size() == x.size() && upperBounds.size() == x.size(), storm::exceptions::InvalidArgumentException, "Bounds need one entry per row group.");
+    for (uint64_t i = 0; i < x.size(); ++i) {
+        STORM_LOG_THROW(lowerBounds[i] <= upperBounds[i], storm::exceptions::InvalidArgumentException, "Lower bound " << lowerBounds[i] << " exceeds upper bound " << upperBounds[i] << " for row group " << i << ".");
+    }
+    MixedPrecisionSolverResult result;
+
+    // Approximate solution in single precision
+    std::vector<double> approximate;
+    {
+        SlicedMatrix<float, IndexType> approximateMatrix(matrix, sortingScope);
+        std::vector<float> approximateB(b.begin(), b.end());
+        std::vector<float> approximateX(x.begin(), x.end());
+        auto approximateResult = approximateMatrix.solveMinMaxEquations(dir, approximateB, std::move(approximateX), static_cast<float>(approximatePrecision), relative, maxIterations);
+        result.approximateIterations = approximateResult.iterations;
+        approximate.assign(approximateResult.values.begin(), approximateResult.values.end());
+    }
+
+    // Warm start of the bounds from the single precision result
+    auto const& groups = matrix.getRowGroupIndices();
+    std::vector<double> next(approximate.size());
+    std::vector<double>& lower = result.lowerValues;
+    std::vector<double>& upper = result.upperValues;
+    for (bool isUpper : {false, true}) {
+        std::vector<double> candidate = approximate;
+        for (uint64_t i = 0; i < candidate.size(); ++i) {
+            double offset = approximatePrecision * (relative ? std::max(std::abs(candidate[i]), 1.0) : 1.0);
+            candidate[i] += isUpper ? offset : -offset;
+        }
+        clampToBounds(candidate, lowerBounds, upperBounds);
+        matrix.multiplyAndReduce(dir, groups, candidate, &b, next, nullptr);
+        bool valid = true;
+        for (uint64_t i = 0; i < candidate.size() && valid; ++i) {
+            valid = isUpper ? next[i] <= candidate[i] : next[i] >= candidate[i];
+        }
+        if (!valid) {
+            candidate = isUpper ? upperBounds : lowerBounds;
+        }
+        (isUpper ? upper : lower) = std::move(candidate);
+    }
+
+    // Interval iteration in double precision. The bounds are kept monotone.
+    result.errorBound = maximalDifference(lower, upper, relative);
+    result.certified = result.errorBound <= precision;
+    while (!result.certified && result.approximateIterations + result.refinementIterations < maxIterations) {
+        bool changed = false;
+        matrix.multiplyAndReduce(dir, groups, lower, &b, next, nullptr);
+        for (uint64_t i = 0; i < next.size(); ++i) {
+            if (next[i] > lower[i]) {
+                lower[i] = std::min(next[i], upper[i]);
+                changed = true;
+            }
+        }
+        matrix.multiplyAndReduce(dir, groups, upper, &b, next, nullptr);
+        for (uint64_t i = 0; i < next.size(); ++i) {
+            if (next[i] < upper[i]) {
+                upper[i] = std::max(next[i], lower[i]);
+                changed = true;
+            }
+        }
+        ++result.refinementIterations;
+        result.errorBound = maximalDifference(lower, upper, relative);
+        result.certified = result.errorBound <= precision;
+        if (!changed) {
+            // Both bounds are fixed points, further iterations cannot close the gap
+            break;
+        }
+    }
+
+    result.values.resize(lower.size());
+    for (uint64_t i = 0; i < lower.size(); ++i) {
+        result.values[i] = lower[i] + (upper[i] - lower[i]) / 2;
+    }
+    return result;
+}
+
+// Microbenchmark comparing repeated multiply-and-reduce on the sparse matrix and its sliced counterpart.
+// Returns the time in seconds for both variants.
+template<typename ValueType, typename IndexType>
+std::pair<double, double> benchmarkMultiplyAndReduce(SparseMatrix<double> const& matrix, SlicedMatrix<ValueType, IndexType> const& sliced, storm::solver::OptimizationDirection dir, uint64_t repetitions) {
+    STORM_LOG_THROW(matrix.getColumnCount() == matrix.getRowGroupCount(), storm::exceptions::InvalidArgumentException, "Benchmark requires as many columns as row groups.");
+    std::vector<double> x(matrix.getColumnCount(), 1.0);
+    std::vector<double> result(matrix.getRowGroupCount());
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < repetitions; ++i) {
+        matrix.multiplyAndReduce(dir, matrix.getRowGroupIndices(), x, nullptr, result, nullptr);
+        std::swap(x, result);
+    }
+    std::chrono::duration<double> sparseTime = std::chrono::steady_clock::now() - start;
+
+    std::vector<ValueType> slicedX(matrix.getColumnCount(), ValueType(1));
+    std::vector<ValueType> slicedRowResult(matrix.getRowCount());
+    std::vector<ValueType> slicedResult(matrix.getRowGroupCount());
+    start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < repetitions; ++i) {
+        sliced.multiplyAndReduce(dir, slicedX, nullptr, slicedRowResult, slicedResult, nullptr);
+        std::swap(slicedX, slicedResult);
+    }
+    std::chrono::duration<double> slicedTime = std::chrono::steady_clock::now() - start;
+    return std::make_pair(sparseTime.count(), slicedTime.count());
+}
+
+
+template<typename ValueType, typename IndexType>
+void define_sliced_matrix_with_index(py::module& m, std::string const& className) {
+    using Sliced = SlicedMatrix<ValueType, IndexType>;
+
+    py::class_<Sliced, std::shared_ptr<Sliced>>(m, className.c_str(), R"dox(
+
+        Sparse matrix in the sliced ELLPACK (SELL-C-sigma) format.
+        Rows are packed into slices which are processed with vector instructions (if stormpy was compiled with AVX2 or AVX-512 support).
+        Indices are stored with the number of bits given by index_bits.
+        The matrix is intended for repeated matrix-vector multiplications, e.g., in value iteration.
+        )dox")
+        .def(py::init<SparseMatrix<double> const&, uint64_t>(), py::arg("matrix"), py::arg("sorting_scope") = 32 * Sliced::sliceHeight, R"dox(
+
+          Convert a sparse matrix into the sliced format.
+
+          :param SparseMatrix matrix: The matrix to convert
+          :param int sorting_scope: Size of the windows in which rows are sorted by length to reduce padding
+          )dox")
+        .def_static("fits", &Sliced::template fits<double>, py::arg("matrix"), "Check whether the dimensions of the matrix fit into the index range")
+        .def_property_readonly_static("index_bits", [](py::object const&) { return 8 * sizeof(IndexType); }, "Number of bits per index")
+        .def_property_readonly_static("value_bits", [](py::object const&) { return 8 * sizeof(ValueType); }, "Number of bits per value")
+        .def_property_readonly("nr_rows", &Sliced::getRowCount, "Number of rows")
+        .def_property_readonly("nr_columns", &Sliced::getColumnCount, "Number of columns")
+        .def_property_readonly("nr_entries", &Sliced::getEntryCount, "Number of non-zero entries")
+        .def_property_readonly("nr_row_groups", &Sliced::getRowGroupCount, "Number of row groups")
+        .def_property_readonly("nr_padded_entries", &Sliced::getPaddedEntryCount, "Number of stored entries including padding")
+        .def_property_readonly_static("slice_height", [](py::object const&) { return Sliced::sliceHeight; }, "Number of rows per slice")
+        .def_property_readonly("size_in_memory", &Sliced::getSizeInMemory, "Size of the matrix in memory (in bytes)")
+        .def("multiply", [](Sliced const& matrix, std::vector<ValueType> const& x, std::optional<std::vector<ValueType>> const& summand) {
+                std::vector<ValueType> result;
+                matrix.multiply(x, summand ? &summand.value() : nullptr, result);
+                return result;
+            }, py::arg("vector"), py::arg("summand") = std::nullopt, "Multiply with vector and add summand. Returns one value per row.")
+        .def("multiply_and_reduce", [](Sliced const& matrix, storm::solver::OptimizationDirection dir, std::vector<ValueType> const& x, std::optional<std::vector<ValueType>> const& summand) {
+                std::vector<ValueType> rowResult;
+                std::vector<ValueType> result;
+                matrix.multiplyAndReduce(dir, x, summand ? &summand.value() : nullptr, rowResult, result, nullptr);
+                return result;
+            }, py::arg("direction"), py::arg("vector"), py::arg("summand") = std::nullopt, "Multiply with vector, add summand and take minimum/maximum over each row group. Returns one value per row group.")
+        .def("solve_min_max_equations", &Sliced::solveMinMaxEquations, py::arg("direction"), py::arg("summand"), py::arg("initial_values"), py::arg("precision") = 1e-6, py::arg("relative") = true,
+             py::arg("maximal_iterations") = std::numeric_limits<uint64_t>::max(), py::call_guard<py::gil_scoped_release>(), R"dox(
+
+          Solve x = min/max (A*x + b) by value iteration.
+
+          :param OptimizationDirection direction: Whether to minimize or maximize over each row group
+          :param List[double] summand: The vector b with one entry per row
+          :param List[double] initial_values: Starting vector with one entry per row group
+          :param double precision: Precision used for the convergence check
+          :param bool relative: Whether the convergence check uses relative precision
+          :param int maximal_iterations: Maximal number of iterations
+          :return: Result containing the values and the number of iterations
+          )dox")
+    ;
+
+    m.def("_benchmark_multiply_and_reduce", &benchmarkMultiplyAndReduce<ValueType, IndexType>, py::arg("matrix"), py::arg("sliced_matrix"), py::arg("direction"), py::arg("repetitions"),
+          py::call_guard<py::gil_scoped_release>(), "Time repeated multiply-and-reduce on the sparse and the sliced matrix. Returns the times in seconds.");
+}
+
+template<typename ValueType>
+void define_sliced_matrix(py::module& m, std::string const& vtSuffix) {
+    py::class_<SlicedSolverResult<ValueType>>(m, (vtSuffix + "SlicedSolverResult").c_str(), "Result of value iteration on a sliced sparse matrix")
+        .def_readonly("values", &SlicedSolverResult<ValueType>::values, "Solution with one value per row group")
+        .def_readonly("iterations", &SlicedSolverResult<ValueType>::iterations, "Number of performed iterations")
+        .def_readonly("converged", &SlicedSolverResult<ValueType>::converged, "Flag whether the last two iterates differ by at most the precision (heuristic convergence criterion, no bound on the error)")
+        .def_readonly("last_difference", &SlicedSolverResult<ValueType>::lastDifference, "Difference between the last two iterates")
+    ;
+
+    define_sliced_matrix_with_index<ValueType, uint32_t>(m, vtSuffix + "SlicedSparseMatrix");
+    define_sliced_matrix_with_index<ValueType, uint64_t>(m, vtSuffix + "SlicedSparseMatrix64");
+}
+
+void define_mixed_precision_solver(py::module& m) {
+    py::class_<MixedPrecisionSolverResult>(m, "MixedPrecisionSolverResult", "Result of value iteration in single precision with refinement by interval iteration in double precision")
+        .def_readonly("values", &MixedPrecisionSolverResult::values, "Midpoint of the lower and upper bounds with one value per row group")
+        .def_readonly("lower_values", &MixedPrecisionSolverResult::lowerValues, "Lower bounds on the solution with one value per row group")
+        .def_readonly("upper_values", &MixedPrecisionSolverResult::upperValues, "Upper bounds on the solution with one value per row group")
+        .def_readonly("approximate_iterations", &MixedPrecisionSolverResult::approximateIterations, "Number of iterations in single precision")
+        .def_readonly("refinement_iterations", &MixedPrecisionSolverResult::refinementIterations, "Number of iterations of interval iteration in double precision")
+        .def_readonly("error_bound", &MixedPrecisionSolverResult::errorBound, "Largest difference between the upper and lower bounds (relative to the lower bound if relative precision is used)")
+        .def_readonly("certified", &MixedPrecisionSolverResult::certified, "Flag whether the error bound is at most the precision")
+    ;
+
+    m.def("_solve_min_max_equations_mixed_precision", &solveMinMaxEquationsMixedPrecision<uint32_t>, py::arg("matrix"), py::arg("direction"), py::arg("summand"), py::arg("initial_values"),
+          py::arg("lower_bounds"), py::arg("upper_bounds"), py::arg("precision") = 1e-6, py::arg("approximate_precision") = 1e-4, py::arg("relative") = true,
+          py::arg("maximal_iterations") = std::numeric_limits<uint64_t>::max(), py::arg("sorting_scope") = 32 * SliceHeight<float>::value, py::call_guard<py::gil_scoped_release>());
+    m.def("_solve_min_max_equations_mixed_precision_index64", &solveMinMaxEquationsMixedPrecision<uint64_t>, py::arg("matrix"), py::arg("direction"), py::arg("summand"), py::arg("initial_values"),
+          py::arg("lower_bounds"), py::arg("upper_bounds"), py::arg("precision") = 1e-6, py::arg("approximate_precision") = 1e-4, py::arg("relative") = true,
+          py::arg("maximal_iterations") = std::numeric_limits<uint64_t>::max(), py::arg("sorting_scope") = 32 * SliceHeight<float>::value, py::call_guard<py::gil_scoped_release>());
+}
+
+template void define_sliced_matrix<double>(py::module& m, std::string const& vtSuffix);
+template void define_sliced_matrix<float>(py::module& m, std::string const& vtSuffix);
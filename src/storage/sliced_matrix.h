@@ -0,0 +1,7 @@
+#pragma once
+
+#include "common.h"
+
+template<typename ValueType>
+void define_sliced_matrix(py::module& m, std::string const& vtSuffix);
+void define_mixed_precision_solver(py::module& m);
@@ -1,12 +1,19 @@
 #include "valuation.h"
 #include "src/helpers.h"
+#include "src/numpy_helpers.h"
 
 #include "storm/adapters/RationalNumberAdapter.h"
 #include "storm/adapters/JsonAdapter.h"
+#include "storm/storage/BitVector.h"
 #include "storm/storage/expressions/ExpressionManager.h"
 #include "storm/storage/expressions/SimpleValuation.h"
 #include "storm/storage/expressions/Variable.h"
 #include "storm/storage/sparse/StateValuations.h"
+#include "storm/utility/constants.h"
+#include "storm/utility/macros.h"
+#include "storm/exceptions/InvalidArgumentException.h"
+
+#include <unordered_map>
 
 // Thin wrappers
 storm::json<storm::RationalNumber> toJson(storm::storage::sparse::StateValuations const& valuations, storm::storage::sparse::state_type const& stateIndex, boost::optional<std::set<storm::expressions::Variable>> const& selectedVariables) {
@@ -17,6 +24,220 @@ void add_state(storm::storage::sparse::StateValuationsBuilder& builder, storm::s
     return builder.addState(state, std::move(booleanValues), std::move(integerValues), std::move(rationalValues));
 }
 
+/*!
+ * Column-wise copy of state valuations with one column per variable.
+ * Booleans and integers are stored as integers, rationals are converted to doubles.
+ * For boolean and integer variables, the states with a given value can be looked up. The corresponding index is built on first use.
+ */
+class StateValuationTable {
+public:
+    StateValuationTable(storm::storage::sparse::StateValuations const& valuations) : stateCount(valuations.getNumberOfStates()) {
+        if (stateCount == 0) {
+            return;
+        }
+        auto range = valuations.at(0);
+        for (auto it = range.begin(); it != range.end(); ++it) {
+            if (it.isVariableAssignment()) {
+                columnIndices[it.getVariable()] = columns.size();
+                columns.push_back(Column{it.getVariable(), it.isBoolean(), !it.isBoolean() && !it.isInteger(), {}, {}, {}});
+            }
+        }
+        for (auto& column : columns) {
+            if (column.isRational) {
+                column.rationalValues.reserve(stateCount);
+            } else {
+                column.integerValues.reserve(stateCount);
+            }
+        }
+        for (uint64_t state = 0; state < stateCount; ++state) {
+            // Variables are traversed in the same order for every state
+            auto column = columns.begin();
+            auto stateRange = valuations.at(state);
+            for (auto it = stateRange.begin(); it != stateRange.end(); ++it) {
+                if (!it.isVariableAssignment()) {
+                    continue;
+                }
+                if (column->isBoolean) {
+                    column->integerValues.push_back(it.getBooleanValue() ? 1 : 0);
+                } else if (column->isRational) {
+                    column->rationalValues.push_back(storm::utility::convertNumber<double>(it.getRationalValue()));
+                } else {
+                    column->integerValues.push_back(it.getIntegerValue());
+                }
+                ++column;
+            }
+        }
+    }
+
+    uint64_t getNumberOfStates() const {
+        return stateCount;
+    }
+
+    std::vector<storm::expressions::Variable> getVariables() const {
+        std::vector<storm::expressions::Variable> variables;
+        for (auto const& column : columns) {
+            variables.push_back(column.variable);
+        }
+        return variables;
+    }
+
+    // Returns the values of the variable for all states or the given subset as NumPy array
+    py::array getColumn(py::object const& self, storm::expressions::Variable const& variable, std::optional<storm::storage::BitVector> const& states) const {
+        Column const& column = getColumn(variable);
+        if (!states) {
+            if (column.isRational) {
+                return vectorAsNumpy(column.rationalValues, self);
+            } else if (column.isBoolean) {
+                // Booleans are stored as integers and need to be converted
+                return selectValues<bool>(column.integerValues, storm::storage::BitVector(stateCount, true));
+            }
+            return vectorAsNumpy(column.integerValues, self);
+        }
+        STORM_LOG_THROW(states->size() == stateCount, storm::exceptions::InvalidArgumentException, "State set has size " << states->size() << " but there are " << stateCount << " states.");
+        if (column.isRational) {
+            return selectValues<double>(column.rationalValues, *states);
+        } else if (column.isBoolean) {
+            return selectValues<bool>(column.integerValues, *states);
+        }
+        return selectValues<int64_t>(column.integerValues, *states);
+    }
+
+    // Returns the (sorted) states in which the variable has the given value
+    py::array_t<uint64_t> getStates(py::object const& self, storm::expressions::Variable const& variable, int64_t value) {
+        Column& column = getColumn(variable);
+        STORM_LOG_THROW(!column.isRational, storm::exceptions::InvalidArgumentException, "Lookup by value is not supported for rational variable " << variable.getName() << ".");
+        if (column.valueToStates.empty()) {
+            for (uint64_t state = 0; state < stateCount; ++state) {
+                column.valueToStates[column.integerValues[state]].push_back(state);
+            }
+        }
+        auto it = column.valueToStates.find(value);
+        if (it == column.valueToStates.end()) {
+            return py::array_t<uint64_t>(0);
+        }
+        return vectorAsNumpy(it->second, self);
+    }
+
+    /*!
+     * Looks up the states for a matrix of values with one row per query and one column per variable.
+     * Returns -1 for rows which do not correspond to a state.
+     * The variables must identify the states uniquely. The hash index for the variables is built on first use.
+     */
+    py::array_t<int64_t> lookup(std::vector<storm::expressions::Variable> const& variables, py::array_t<int64_t, py::array::c_style | py::array::forcecast> const& values) {
+        STORM_LOG_THROW(values.ndim() == 2 && static_cast<uint64_t>(values.shape(1)) == variables.size(), storm::exceptions::InvalidArgumentException,
+                        "Values must be given as matrix with one column per variable.");
+        std::vector<uint64_t> indices;
+        for (auto const& variable : variables) {
+            indices.push_back(columnIndices.count(variable) > 0 ? columnIndices.at(variable) : columns.size());
+        }
+        LookupIndex const& index = getLookupIndex(indices);
+
+        uint64_t queryCount = values.shape(0);
+        py::array_t<int64_t> result(queryCount);
+        int64_t const* data = values.data();
+        int64_t* resultData = result.mutable_data();
+        {
+            py::gil_scoped_release release;
+            for (uint64_t query = 0; query < queryCount; ++query) {
+                int64_t const* row = data + query * indices.size();
+                resultData[query] = -1;
+                auto range = index.equal_range(hashValues(row, indices.size()));
+                for (auto it = range.first; it != range.second; ++it) {
+                    if (matches(it->second, indices, row)) {
+                        resultData[query] = it->second;
+                        break;
+                    }
+                }
+            }
+        }
+        return result;
+    }
+
+private:
+    // Map from hashed values to states
+    typedef std::unordered_multimap<uint64_t, uint64_t> LookupIndex;
+
+    struct Column {
+        storm::expressions::Variable variable;
+        bool isBoolean;
+        bool isRational;
+        std::vector<int64_t> integerValues;
+        std::vector<double> rationalValues;
+        // Reverse index from values to states
+        std::unordered_map<int64_t, std::vector<uint64_t>> valueToStates;
+    };
+
+    uint64_t stateCount;
+    std::vector<Column> columns;
+    std::map<storm::expressions::Variable, uint64_t> columnIndices;
+    std::map<std::vector<uint64_t>, LookupIndex> lookupIndices;
+
+    static uint64_t hashValues(int64_t const* values, uint64_t count) {
+        uint64_t hash = 0;
+        for (uint64_t i = 0; i < count; ++i) {
+            hash ^= static_cast<uint64_t>(values[i]) + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+        }
+        return hash;
+    }
+
+    bool matches(uint64_t state, std::vector<uint64_t> const& indices, int64_t const* values) const {
+        for (uint64_t i = 0; i < indices.size(); ++i) {
+            if (columns[indices[i]].integerValues[state] != values[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    LookupIndex const& getLookupIndex(std::vector<uint64_t> const& indices) {
+        auto it = lookupIndices.find(indices);
+        if (it != lookupIndices.end()) {
+            return it->second;
+        }
+        for (uint64_t index : indices) {
+            STORM_LOG_THROW(index < columns.size(), storm::exceptions::InvalidArgumentException, "Lookup contains a variable without valuation.");
+            STORM_LOG_THROW(!columns[index].isRational, storm::exceptions::InvalidArgumentException, "Lookup by value is not supported for rational variable " << columns[index].variable.getName() << ".");
+        }
+        LookupIndex index;
+        index.reserve(stateCount);
+        std::vector<int64_t> values(indices.size());
+        for (uint64_t state = 0; state < stateCount; ++state) {
+            for (uint64_t i = 0; i < indices.size(); ++i) {
+                values[i] = columns[indices[i]].integerValues[state];
+            }
+            uint64_t hash = hashValues(values.data(), values.size());
+            auto range = index.equal_range(hash);
+            for (auto other = range.first; other != range.second; ++other) {
+                STORM_LOG_THROW(!matches(other->second, indices, values.data()), storm::exceptions::InvalidArgumentException,
+                                "States " << other->second << " and " << state << " have the same values for the given variables.");
+            }
+            index.emplace(hash, state);
+        }
+        return lookupIndices.emplace(indices, std::move(index)).first->second;
+    }
+
+    Column& getColumn(storm::expressions::Variable const& variable) {
+        auto it = columnIndices.find(variable);
+        STORM_LOG_THROW(it != columnIndices.end(), storm::exceptions::InvalidArgumentException, "Variable " << variable.getName() << " has no valuation.");
+        return columns[it->second];
+    }
+
+    Column const& getColumn(storm::expressions::Variable const& variable) const {
+        return const_cast<StateValuationTable*>(this)->getColumn(variable);
+    }
+
+    template<typename TargetType, typename SourceType>
+    static py::array_t<TargetType> selectValues(std::vector<SourceType> const& values, storm::storage::BitVector const& states) {
+        py::array_t<TargetType> result(states.getNumberOfSetBits());
+        auto data = result.mutable_unchecked<1>();
+        py::ssize_t i = 0;
+        for (auto state : states) {
+            data(i++) = static_cast<TargetType>(values[state]);
+        }
+        return result;
+    }
+};
+
 
 // Define python bindings
 void define_statevaluation(py::module& m) {
@@ -38,6 +259,40 @@ void define_statevaluation(py::module& m) {
             .def("build", &storm::storage::sparse::StateValuationsBuilder::build, "Creates the finalized state valuations object")
             ;
 
+    py::class_<StateValuationTable, std::shared_ptr<StateValuationTable>>(m, "StateValuationTable", R"dox(
+
+        Column-wise state valuations with one array per variable.
+        Boolean and integer variables additionally support looking up the states with a given value.
+        )dox")
+        .def(py::init<storm::storage::sparse::StateValuations const&>(), py::arg("state_valuations"), py::call_guard<py::gil_scoped_release>(), "Create table from state valuations")
+        .def_property_readonly("nr_states", &StateValuationTable::getNumberOfStates, "Number of states")
+        .def_property_readonly("variables", &StateValuationTable::getVariables, "Variables in the table")
+        .def("get_column", [](py::object const& self, storm::expressions::Variable const& variable, std::optional<storm::storage::BitVector> const& states) {
+                return self.cast<StateValuationTable const&>().getColumn(self, variable, states);
+            }, py::arg("variable"), py::arg("states") = std::nullopt, R"dox(
+
+            Get the values of a variable as NumPy array.
+
+            :param Variable variable: The variable
+            :param BitVector states: If given, only the values for these states are returned
+            :return: Array with one value per state (bool, int64 or float)
+            )dox")
+        .def("get_states", [](py::object const& self, storm::expressions::Variable const& variable, int64_t value) {
+                return self.cast<StateValuationTable&>().getStates(self, variable, value);
+            }, py::arg("variable"), py::arg("value"), "Get the states in which the boolean or integer variable has the given value as sorted NumPy array")
+        .def("lookup", [](StateValuationTable& table, py::array_t<int64_t, py::array::c_style | py::array::forcecast> const& values, std::optional<std::vector<storm::expressions::Variable>> const& variables) {
+                return table.lookup(variables ? *variables : table.getVariables(), values);
+            }, py::arg("values"), py::arg("variables") = std::nullopt, R"dox(
+
+            Look up states by the values of their variables.
+            The lookup uses a hash index which is built once per set of variables.
+
+            :param values: Integer matrix with one row per query and one column per variable. Booleans are given as 0 and 1.
+            :param List[Variable] variables: Variables corresponding to the columns. If None, all variables of the table are used in their order.
+            :return: NumPy array with the state index for each row (-1 if no state has these values)
+            )dox")
+    ;
+
 }
 
 void define_simplevaluation(py::module& m) {
@@ -1,11 +1,250 @@
 #include "shortestPaths.h"
 #include "storm/utility/shortestPaths.h"
 #include "src/helpers.h"
+#include "src/numpy_helpers.h"
 
 // only forward declaring Model leads to pybind compilation error
 // this may be avoidable. but including certainly works.
 #include "storm/models/sparse/Model.h"
 #include "storm/models/sparse/StandardRewardModel.h"
+#include "storm/utility/macros.h"
+#include "storm/exceptions/InvalidArgumentException.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <queue>
+#include <thread>
+
+// First K shortest paths for one target set. Path k consists of states[offsets[k]] to states[offsets[k+1]-1], starting in an initial state.
+struct KShortestPathsResult {
+    std::vector<double> distances;
+    std::vector<uint64_t> offsets = {0};
+    std::vector<uint64_t> states;
+};
+
+// Predecessor relation of a model which is shared by the computations for all target sets
+class ShortestPathsGraph {
+public:
+    ShortestPathsGraph(storm::storage::SparseMatrix<double> const& matrix, storm::storage::BitVector const& initialStates) : matrix(matrix), initialStates(initialStates) {
+        uint64_t stateCount = matrix.getRowGroupCount();
+        STORM_LOG_THROW(initialStates.size() == stateCount, storm::exceptions::InvalidArgumentException, "Initial states have wrong size.");
+        // Parallel edges (from different choices) are merged by keeping the maximal probability
+        std::vector<std::vector<std::pair<uint64_t, double>>> edges(stateCount);
+        for (uint64_t state = 0; state < stateCount; ++state) {
+            for (auto const& entry : matrix.getRowGroup(state)) {
+                if (entry.getValue() <= 0) {
+                    continue;
+                }
+                auto& incoming = edges[entry.getColumn()];
+                if (!incoming.empty() && incoming.back().first == state) {
+                    incoming.back().second = std::max(incoming.back().second, entry.getValue());
+                } else {
+                    incoming.emplace_back(state, entry.getValue());
+                }
+            }
+        }
+        predecessorOffsets.push_back(0);
+        for (auto const& incoming : edges) {
+            predecessors.insert(predecessors.end(), incoming.begin(), incoming.end());
+            predecessorOffsets.push_back(predecessors.size());
+        }
+    }
+
+    storm::storage::SparseMatrix<double> const& matrix;
+    storm::storage::BitVector const& initialStates;
+    // Predecessors with the (maximal) transition probability in CSR format
+    std::vector<uint64_t> predecessorOffsets;
+    std::vector<std::pair<uint64_t, double>> predecessors;
+};
+
+/*!
+ * Recursive enumeration algorithm (Jimenez and Marzal) for the most probable paths from the initial states to a target set,
+ * as in ShortestPathsGenerator. Paths end in the first target state they visit. The target states are connected to an
+ * additional meta target whose k-th shortest path yields the k-th path.
+ */
+class KShortestPaths {
+public:
+    KShortestPaths(ShortestPathsGraph const& graph, storm::storage::BitVector const& targets)
+        : graph(graph), targets(targets), metaTarget(targets.size()), paths(targets.size() + 1), candidates(targets.size() + 1), candidatesInitialized(targets.size() + 1, false),
+          exhausted(targets.size() + 1, false) {
+        computeShortestPathTree();
+    }
+
+    KShortestPathsResult compute(uint64_t k) {
+        KShortestPathsResult result;
+        for (uint64_t index = 0; index < k; ++index) {
+            if (index >= paths[metaTarget].size() && !computeNextPath(metaTarget)) {
+                break;
+            }
+            result.distances.push_back(paths[metaTarget][index].distance);
+            uint64_t start = result.states.size();
+            // Follow the predecessors back to an initial state
+            Path const* path = &paths[metaTarget][index];
+            while (path->predecessor != none) {
+                result.states.push_back(path->predecessor);
+                path = &paths[path->predecessor][path->predecessorK];
+            }
+            std::reverse(result.states.begin() + start, result.states.end());
+            result.offsets.push_back(result.states.size());
+        }
+        return result;
+    }
+
+private:
+    static constexpr uint64_t none = std::numeric_limits<uint64_t>::max();
+
+    // A path to a node is given by its last edge and the index of the path to the predecessor
+    struct Path {
+        uint64_t predecessor;
+        uint64_t predecessorK;
+        double weight;
+        double distance;
+
+        bool operator<(Path const& other) const {
+            return distance < other.distance;
+        }
+    };
+
+    ShortestPathsGraph const& graph;
+    storm::storage::BitVector const& targets;
+    uint64_t metaTarget;
+    std::vector<std::vector<Path>> paths;
+    std::vector<std::priority_queue<Path>> candidates;
+    std::vector<bool> candidatesInitialized;
+    std::vector<bool> exhausted;
+
+    // Calls the function for each predecessor of the node. Targets have no successors except the meta target.
+    template<typename Function>
+    void forEachPredecessor(uint64_t node, Function const& function) const {
+        if (node == metaTarget) {
+            for (uint64_t target : targets) {
+                function(target, 1.0);
+            }
+            return;
+        }
+        for (uint64_t i = graph.predecessorOffsets[node]; i < graph.predecessorOffsets[node + 1]; ++i) {
+            if (!targets.get(graph.predecessors[i].first)) {
+                function(graph.predecessors[i].first, graph.predecessors[i].second);
+            }
+        }
+    }
+
+    // Dijkstra on the (max,*) semiring yields the first path to each node
+    void computeShortestPathTree() {
+        std::vector<double> distances(metaTarget + 1, 0.0);
+        std::vector<uint64_t> predecessors(metaTarget + 1, none);
+        std::vector<double> weights(metaTarget + 1, 1.0);
+        std::priority_queue<std::pair<double, uint64_t>> queue;
+        for (uint64_t state : graph.initialStates) {
+            distances[state] = 1.0;
+            queue.emplace(1.0, state);
+        }
+        while (!queue.empty()) {
+            double distance = queue.top().first;
+            uint64_t node = queue.top().second;
+            queue.pop();
+            if (distance < distances[node] || node == metaTarget) {
+                continue;
+            }
+            auto relax = [&](uint64_t successor, double weight) {
+                if (distance * weight > distances[successor]) {
+                    distances[successor] = distance * weight;
+                    predecessors[successor] = node;
+                    weights[successor] = weight;
+                    queue.emplace(distances[successor], successor);
+                }
+            };
+            if (targets.get(node)) {
+                relax(metaTarget, 1.0);
+                continue;
+            }
+            for (auto const& entry : graph.matrix.getRowGroup(node)) {
+                if (entry.getValue() > 0) {
+                    relax(entry.getColumn(), entry.getValue());
+                }
+            }
+        }
+        for (uint64_t node = 0; node <= metaTarget; ++node) {
+            if (distances[node] > 0) {
+                paths[node].push_back(Path{predecessors[node], 0, weights[node], distances[node]});
+            }
+        }
+    }
+
+    // Computes the next path to the given node. Returns false if no further path exists.
+    bool computeNextPath(uint64_t node) {
+        if (paths[node].empty() || exhausted[node]) {
+            return false;
+        }
+        auto& nodeCandidates = candidates[node];
+        if (!candidatesInitialized[node]) {
+            Path const& first = paths[node].front();
+            forEachPredecessor(node, [&](uint64_t predecessor, double weight) {
+                if (!paths[predecessor].empty() && predecessor != first.predecessor) {
+                    nodeCandidates.push(Path{predecessor, 0, weight, paths[predecessor].front().distance * weight});
+                }
+            });
+            candidatesInitialized[node] = true;
+        }
+        // Extend the next path to the predecessor of the last path
+        Path last = paths[node].back();
+        if (last.predecessor != none) {
+            uint64_t nextK = last.predecessorK + 1;
+            if (nextK < paths[last.predecessor].size() || computeNextPath(last.predecessor)) {
+                nodeCandidates.push(Path{last.predecessor, nextK, last.weight, paths[last.predecessor][nextK].distance * last.weight});
+            }
+        }
+        if (nodeCandidates.empty()) {
+            exhausted[node] = true;
+            return false;
+        }
+        paths[node].push_back(nodeCandidates.top());
+        nodeCandidates.pop();
+        return true;
+    }
+};
+
+std::vector<KShortestPathsResult> computeKShortestPaths(storm::models::sparse::Model<double> const& model, std::vector<storm::storage::BitVector> const& targetSets, uint64_t k,
+                                                        uint64_t threads) {
+    ShortestPathsGraph graph(model.getTransitionMatrix(), model.getInitialStates());
+    for (auto const& targets : targetSets) {
+        STORM_LOG_THROW(targets.size() == model.getNumberOfStates(), storm::exceptions::InvalidArgumentException, "Target states have wrong size.");
+    }
+    std::vector<KShortestPathsResult> results(targetSets.size());
+    std::atomic<uint64_t> next(0);
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    auto work = [&]() {
+        for (uint64_t index = next++; index < targetSets.size(); index = next++) {
+            try {
+                results[index] = KShortestPaths(graph, targetSets[index]).compute(k);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                error = std::current_exception();
+            }
+        }
+    };
+    threads = threads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : threads;
+    threads = std::min<uint64_t>(threads, targetSets.size());
+    if (threads <= 1) {
+        work();
+    } else {
+        std::vector<std::thread> workers;
+        for (uint64_t i = 0; i < threads; ++i) {
+            workers.emplace_back(work);
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return results;
+}
 
 
 void define_ksp(py::module& m) {
@@ -60,4 +299,30 @@ void define_ksp(py::module& m) {
         .def("get_states", &ShortestPathsGenerator::getStates, "k"_a)
         .def("get_path_as_list", &ShortestPathsGenerator::getPathAsList, "k"_a)
     ;
+
+    py::class_<KShortestPathsResult>(m, "KShortestPathsResult", "First k shortest paths for a target set as flat arrays")
+        .def_property_readonly("nr_paths", [](KShortestPathsResult const& result) { return result.distances.size(); }, "Number of paths, less than k if there are fewer paths")
+        .def_property_readonly("distances", [](py::object const& self) { return vectorAsNumpy(self.cast<KShortestPathsResult const&>().distances, self); }, "Probability of each path")
+        .def_property_readonly("offsets", [](py::object const& self) { return vectorAsNumpy(self.cast<KShortestPathsResult const&>().offsets, self); },
+                               "Path i consists of the states at positions offsets[i] to offsets[i+1]")
+        .def_property_readonly("states", [](py::object const& self) { return vectorAsNumpy(self.cast<KShortestPathsResult const&>().states, self); },
+                               "States of all paths, each path from an initial state to a target state")
+        .def("get_path", [](KShortestPathsResult const& result, uint64_t index) {
+                STORM_LOG_THROW(index < result.distances.size(), storm::exceptions::InvalidArgumentException, "Path " << index << " does not exist.");
+                return std::vector<uint64_t>(result.states.begin() + result.offsets[index], result.states.begin() + result.offsets[index + 1]);
+            }, "index"_a, "Get the states of the path with the given index (starting at 0)")
+    ;
+
+    m.def("compute_k_shortest_paths", &computeKShortestPaths, "model"_a, "target_sets"_a, "k"_a, "threads"_a = 0, py::call_guard<py::gil_scoped_release>(), R"dox(
+
+        Compute the k most probable paths from the initial states to each of the given target sets.
+        The predecessor relation of the model is computed once and shared by all target sets, which are processed in parallel.
+        Paths are the same as the ones of ShortestPathsGenerator but in forward order.
+
+        :param model: Model
+        :param List[BitVector] target_sets: Target sets
+        :param int k: Number of paths per target set
+        :param int threads: Number of threads. If 0, the number of hardware threads is used.
+        :return: List containing the paths for each target set
+        )dox");
 }
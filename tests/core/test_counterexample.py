@@ -0,0 +1,32 @@
+import stormpy
+import math
+from helpers.helper import get_example_path
+
+
+class TestCounterexample:
+    def test_critical_subsystem_dtmc(self):
+        program = stormpy.parse_prism_program(get_example_path("dtmc", "die.pm"))
+        formulas = stormpy.parse_properties_for_prism_program("P<=0.1 [ F \"one\" ]", program)
+        model = stormpy.build_model(program, formulas)
+        for heuristic in ["greedy", "local_search"]:
+            result = stormpy.compute_critical_subsystem(model, formulas[0].raw_formula, time_limit=5, heuristics=[heuristic], threads=1)
+            assert result.critical
+            assert result.probability > 0.1
+            assert result.states.get(model.initial_states[0])
+            # The most probable path 0-1-3-7 has probability 1/8
+            assert result.nr_states == 4
+            # The reported probability is the full probability of the subsystem including the loop 1-3-1
+            assert result.converged
+            assert math.isclose(result.probability, 1 / 6, rel_tol=1e-6)
+        result = stormpy.compute_critical_subsystem(model, formulas[0].raw_formula, time_limit=5)
+        assert result.critical
+        assert result.heuristic in ["greedy", "local_search"]
+
+    def test_critical_subsystem_mdp(self):
+        program = stormpy.parse_prism_program(get_example_path("mdp", "coin2-2.nm"))
+        formulas = stormpy.parse_properties_for_prism_program("P<=0.3 [ F \"finished\" & \"all_coins_equal_1\"]", program)
+        model = stormpy.build_model(program, formulas)
+        result = stormpy.compute_critical_subsystem(model, formulas[0].raw_formula, time_limit=5)
+        assert result.critical
+        assert result.probability > 0.3
+        assert result.nr_states < model.nr_states
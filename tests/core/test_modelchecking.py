@@ -1,7 +1,7 @@
 import stormpy
 from helpers.helper import get_example_path
 
-from configurations import spot
+from configurations import numpy_avail, spot
 
 import math
 
@@ -44,6 +44,24 @@ class TestModelChecking:
         result = stormpy.model_checking(model, formulas[0])
         assert math.isclose(result.at(initial_state), 49 / 128, rel_tol=1e-5)
 
+    @numpy_avail
+    def test_model_checking_mdp_policy_iteration(self):
+        program = stormpy.parse_prism_program(get_example_path("mdp", "coin2-2.nm"))
+        formulas = stormpy.parse_properties_for_prism_program("Pmin=? [ F \"finished\" & \"all_coins_equal_1\"]", program)
+        model = stormpy.build_model(program, formulas)
+        initial_state = model.initial_states[0]
+        result = stormpy.check_mdp_policy_iteration(model, formulas[0].raw_formula, precision=1e-10)
+        assert result.converged
+        assert math.isclose(result.values[initial_state], 49 / 128, rel_tol=1e-5)
+        assert len(result.choices) == model.nr_states
+        assert len(result.evaluation_iterations) == result.nr_iterations
+        assert len(result.improvements) == result.nr_iterations - 1
+        # Warm start from the optimal policy
+        warm = stormpy.check_mdp_policy_iteration(model, formulas[0].raw_formula, initial_choices=result.choices, precision=1e-10)
+        assert warm.converged
+        assert warm.nr_iterations <= result.nr_iterations
+        assert math.isclose(warm.values[initial_state], 49 / 128, rel_tol=1e-5)
+
     def test_model_checking_interval_mdp(self):
         model = stormpy.build_interval_model_from_drn(get_example_path("imdp", "tiny-01.drn"))
         formulas = stormpy.parse_properties("Pmax=? [ F \"target\"];Pmin=? [ F \"target\"]")
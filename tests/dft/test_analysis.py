@@ -24,6 +24,47 @@ class TestAnalysis:
         assert model.nr_transitions == 5
         assert not model.supports_parameters
 
+    def test_build_model_parallel(self):
+        dft = stormpy.dft.load_dft_json_file(get_example_path("dft", "and.json"))
+        model = stormpy.dft.build_model_parallel(dft, threads=2)
+        assert model.model_type == stormpy.ModelType.CTMC
+        assert type(model) is stormpy.SparseCtmc
+        assert model.nr_states == 4
+        assert model.nr_transitions == 5
+        assert not model.supports_parameters
+
+    def test_parallel_model_builder(self):
+        dft = stormpy.dft.load_dft_galileo_file(get_example_path("dft", "rc.dft"))
+        prop = stormpy.parse_properties("T=? [ F \"failed\" ]")[0]
+        sequential = stormpy.dft.build_model(dft)
+        builder = stormpy.dft.ParallelDFTModelBuilder_double(dft, threads=4)
+        builder.build()
+        model = builder.get_model()
+        assert model.model_type == stormpy.ModelType.CTMC
+        assert model.nr_states == sequential.nr_states
+        assert model.nr_transitions == sequential.nr_transitions
+        stats = builder.statistics
+        assert stats.threads == 4
+        assert stats.states == model.nr_states
+        assert stats.transitions == model.nr_transitions
+        assert stats.states_per_second >= 0
+        result = stormpy.model_checking(model, prop).at(model.initial_states[0])
+        result_sequential = stormpy.model_checking(sequential, prop).at(sequential.initial_states[0])
+        assert math.isclose(result, result_sequential)
+
+    def test_parallel_model_builder_thread_independent(self):
+        # Many states fail the top level event, hence several workers reach the unique failed state
+        dft = stormpy.dft.load_dft_galileo_file(get_example_path("dft", "hecs.dft"))
+        sequential = stormpy.dft.build_model(dft)
+        single = stormpy.dft.build_model_parallel(dft, threads=1)
+        assert single.nr_states == sequential.nr_states
+        assert single.nr_transitions == sequential.nr_transitions
+        for threads in [2, 4, 8]:
+            model = stormpy.dft.build_model_parallel(dft, threads=threads)
+            assert model.nr_states == single.nr_states
+            assert model.nr_transitions == single.nr_transitions
+            assert model.labeling.get_states("failed").number_of_set_bits() == 1
+
     def test_explicit_model_builder(self):
         dft = stormpy.dft.load_dft_json_file(get_example_path("dft", "and.json"))
         builder = stormpy.dft.ExplicitDFTModelBuilder_double(dft)
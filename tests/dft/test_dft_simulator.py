@@ -54,6 +54,29 @@ class TestSimulator:
         res = simulator.simulate_trace(2)
         assert res == stormpy.dft.SimulationResult.UNSUCCESSFUL
 
+    def test_simulate_batch(self):
+        from stormpy.dft.simulator import DftSimulator
+        dft = stormpy.dft.load_dft_json_file(get_example_path("dft", "and.json"))
+        simulator = DftSimulator(dft)
+        result = simulator.simulate_batch([2, 1], 5000, seed=5, threads=2)
+        assert result.nr_traces == 5000
+        assert result.invalid_traces == 0
+        assert result.time_bounds == [1, 2]
+        assert result.failed_traces[0] <= result.failed_traces[1]
+        for i in range(2):
+            assert 0 < result.unreliability[i] < 1
+            assert result.lower_bounds[i] <= result.unreliability[i] <= result.upper_bounds[i]
+        # Results are independent of the number of threads
+        result2 = simulator.simulate_batch([2, 1], 5000, seed=5, threads=1)
+        assert result2.failed_traces == result.failed_traces
+        # A single time bound can be given directly
+        single = simulator.simulate_batch(2, 5000, seed=5, threads=2)
+        assert single.failed_traces == [result.failed_traces[1]]
+        # Forcing yields consistent estimates
+        forced = simulator.simulate_batch(2, 5000, seed=5, threads=2, forcing=True)
+        assert forced.lower_bounds[0] <= result.upper_bounds[1]
+        assert result.lower_bounds[1] <= forced.upper_bounds[0]
+
     def test_steps(self):
         dft = stormpy.dft.load_dft_json_file(get_example_path("dft", "and.json"))
         dft.set_relevant_events(stormpy.dft.RelevantEvents(), False)
@@ -0,0 +1,43 @@
+import stormpy
+
+from configurations import pomdp
+
+from helpers.helper import get_example_path
+
+
+@pomdp
+class TestPomdpQualitative:
+    def test_winning_region_portfolio(self):
+        program = stormpy.parse_prism_program(get_example_path("pomdp", "maze_2.prism"))
+        formulas = stormpy.parse_properties_for_prism_program("Pmax=? [F \"goal\"]", program)
+        model = stormpy.build_model(program, formulas)
+        model = stormpy.pomdp.make_canonic(model)
+        model = stormpy.pomdp.prepare_pomdp_for_qualitative_search_Double(model, formulas[0].raw_formula)
+        options = stormpy.pomdp.IterativeQualitativeSearchOptions()
+        result = stormpy.pomdp.compute_winning_region_portfolio_Double(model, formulas[0].raw_formula, [1, 5], options, threads=1)
+        assert [configuration.lookahead for configuration in result.configurations] == [1, 5]
+        assert result.configurations[0].started
+        # Every state can reach the goal, hence a randomized observation-based policy reaches it almost surely
+        assert result.initial_states_winning
+        winner = result.winner
+        assert winner is not None
+        assert result.configurations[winner].started
+        assert result.configurations[winner].initial_states_winning
+        # No configuration is started after the proof
+        assert all(not configuration.started for configuration in result.configurations[winner + 1:])
+
+        # The verdicts coincide with the plain search using the same lookahead
+        for configuration in result.configurations:
+            if configuration.started:
+                solver = stormpy.pomdp.create_iterative_qualitative_search_solver_Double(model, formulas[0].raw_formula, options)
+                assert solver.compute_winning_policy_for_initial_states(configuration.lookahead) == configuration.initial_states_winning
+
+        # The merged winning region can be queried
+        assert result.winning_region is not None
+        query = stormpy.pomdp.BeliefSupportWinningRegionQueryInterfaceDouble(model, result.winning_region)
+        initial_support = stormpy.BitVector(model.nr_states, [model.initial_states[0]])
+        assert query.query_current_belief(initial_support)
+
+        # Parallel threads yield the same verdict
+        parallel = stormpy.pomdp.compute_winning_region_portfolio_Double(model, formulas[0].raw_formula, [1, 5], options, threads=2)
+        assert parallel.initial_states_winning
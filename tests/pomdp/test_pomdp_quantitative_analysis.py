@@ -5,6 +5,7 @@ from configurations import pomdp
 from helpers.helper import get_example_path
 
 import math
+import pytest
 
 @pomdp
 class TestPomdpQuantitative:
@@ -57,4 +58,77 @@ class TestPomdpQuantitative:
         assert math.isclose(result.upper_bound, 19.781437, abs_tol=10**-6)
         assert result.induced_mc_from_scheduler.nr_states == 9
         assert result.induced_mc_from_scheduler.nr_transitions == 15
-        assert len(result.cutoff_schedulers) == 3
\ No newline at end of file
+        assert len(result.cutoff_schedulers) == 3
+
+    def test_parallel_belief_exploration(self):
+        program = stormpy.parse_prism_program(get_example_path("pomdp", "maze_2.prism"))
+        formulas = stormpy.parse_properties_for_prism_program("Pmax=? [ !\"bad\" U \"goal\" ]", program)
+        model = stormpy.build_model(program, formulas)
+        model = stormpy.pomdp.make_canonic(model)
+        options = stormpy.pomdp.ParallelBeliefExplorationOptions()
+        options.threads = 2
+        options.max_beliefs = 100
+        result = stormpy.pomdp.explore_belief_mdp_parallel(model, options)
+        stats = result.statistics
+        assert stats.threads == 2
+        assert stats.explored_beliefs <= stats.discovered_beliefs
+        assert result.belief_mdp.nr_states == stats.discovered_beliefs
+        assert result.cutoff_states.number_of_set_bits() == stats.discovered_beliefs - stats.explored_beliefs
+        assert stats.exploration_rate >= 0
+        assert 0 < stats.distinct_supports <= stats.discovered_beliefs
+        assert stats.bytes_per_belief > 0
+        assert math.isclose(sum(result.get_belief(0).values()), 1.0)
+        # Cutoff beliefs yield lower and upper bounds
+        lower = stormpy.parse_properties("Pmax=? [ !\"bad\" & !\"cutoff\" U \"goal\" ]")[0]
+        upper = stormpy.parse_properties("Pmax=? [ !\"bad\" U (\"goal\" | \"cutoff\") ]")[0]
+        initial = result.belief_mdp.initial_states[0]
+        lower_result = stormpy.model_checking(result.belief_mdp, lower).at(initial)
+        upper_result = stormpy.model_checking(result.belief_mdp, upper).at(initial)
+        assert lower_result <= upper_result + 1e-9
+
+        # Coarse precisions keep non-empty beliefs, too coarse precisions are rejected
+        options.precision = 0.4
+        result = stormpy.pomdp.explore_belief_mdp_parallel(model, options)
+        for state in range(result.belief_mdp.nr_states):
+            assert len(result.get_belief(state)) > 0
+        options.precision = 0.5
+        with pytest.raises(stormpy.StormError):
+            stormpy.pomdp.explore_belief_mdp_parallel(model, options)
+
+    def test_interactive_bounds_callback(self):
+        program = stormpy.parse_prism_program(get_example_path("pomdp", "maze_2.prism"))
+        formulas = stormpy.parse_properties_for_prism_program("Pmax=? [ !\"bad\" U \"goal\" ]", program)
+        model = stormpy.build_model(program, formulas)
+        model = stormpy.pomdp.make_canonic(model)
+        options = stormpy.pomdp.BeliefExplorationModelCheckerOptionsDouble(False, True)
+        options.interactive_unfolding = True
+        belmc = stormpy.pomdp.BeliefExplorationModelCheckerDouble(model, options)
+        updates = []
+        result = belmc.check_with_bounds_callback(formulas[0].raw_formula, [], lambda update: updates.append(update), target_gap=0.01, update_interval=0.001)
+        assert result.lower_bound <= result.upper_bound + 1e-6
+        for previous, update in zip(updates, updates[1:]):
+            assert previous.time <= update.time
+            assert previous.lower_bound < update.lower_bound or previous.upper_bound > update.upper_bound
+        assert len(updates) > 0
+        for update in updates:
+            assert update.lower_bound <= update.upper_bound + 1e-6
+        # The final bounds are reported
+        assert math.isclose(updates[-1].lower_bound, result.lower_bound) and math.isclose(updates[-1].upper_bound, result.upper_bound)
+
+        # Unfolding stops once the gap is small enough, i.e., after the first interactive update (and the final one)
+        belmc = stormpy.pomdp.BeliefExplorationModelCheckerDouble(model, options)
+        gap_updates = []
+        belmc.check_with_bounds_callback(formulas[0].raw_formula, [], lambda update: gap_updates.append(update), target_gap=1, update_interval=0.001)
+        assert 1 <= len(gap_updates) <= 2
+        assert gap_updates[0].upper_bound - gap_updates[0].lower_bound <= 1
+
+        # Returning False stops unfolding and no further updates are reported
+        belmc = stormpy.pomdp.BeliefExplorationModelCheckerDouble(model, options)
+        stop_updates = []
+
+        def stop(update):
+            stop_updates.append(update)
+            return False
+
+        belmc.check_with_bounds_callback(formulas[0].raw_formula, [], stop, update_interval=0.001)
+        assert len(stop_updates) == 1
@@ -0,0 +1,71 @@
+import stormpy
+
+from configurations import pomdp
+
+from helpers.helper import get_example_path
+
+import math
+import pytest
+
+
+@pomdp
+class TestPomdpTracker:
+    def test_batched_belief_tracker(self):
+        program = stormpy.parse_prism_program(get_example_path("pomdp", "maze_2.prism"))
+        model = stormpy.build_model(program)
+        model = stormpy.pomdp.make_canonic(model)
+        initial_state = model.initial_states[0]
+        row = model.transition_matrix.get_row_group_start(initial_state)
+        successor = next(iter(model.transition_matrix.get_row(row))).column
+        observation = model.get_observation(successor)
+
+        tracker = stormpy.pomdp.BatchedBeliefTrackerDouble(model, 2)
+        assert tracker.nr_traces == 2
+        assert tracker.add_traces(1) == 2
+        # The impossible observation invalidates trace 1
+        impossible = max(model.get_observation(state) for state in range(model.nr_states)) + 1
+        tracker.track([0, 1], [0, 0], [observation, impossible], threads=2)
+        assert tracker.is_valid(0)
+        assert not tracker.is_valid(1)
+        assert tracker.is_valid(2)
+        assert tracker.get_belief(2) == {initial_state: 1.0}
+        belief = tracker.get_belief(0)
+        assert math.isclose(sum(belief.values()), 1.0)
+        assert all(model.get_observation(state) == observation for state in belief)
+
+        # Compare with the tracker for belief supports
+        support_tracker = stormpy.pomdp.BeliefSupportTrackerDouble(model)
+        support_tracker.track(0, observation)
+        assert tracker.get_belief_support(0) == support_tracker.get_current_belief_support()
+
+        tracker.reset(1)
+        assert tracker.is_valid(1)
+
+        # An invalid action is detected before any belief is updated
+        invalid_action = model.get_nr_available_actions(initial_state)
+        with pytest.raises(stormpy.StormError):
+            tracker.track([1, 2], [0, invalid_action], [observation, observation], threads=2)
+        assert tracker.get_belief(1) == {initial_state: 1.0}
+        assert tracker.get_belief(2) == {initial_state: 1.0}
+
+    def test_observation_split_transitions(self):
+        program = stormpy.parse_prism_program(get_example_path("pomdp", "maze_2.prism"))
+        model = stormpy.build_model(program)
+        model = stormpy.pomdp.make_canonic(model)
+        transitions = stormpy.pomdp.ObservationSplitTransitions(model)
+        nr_entries = 0
+        for state in range(model.nr_states):
+            for action in range(model.get_nr_available_actions(state)):
+                row = transitions.get_row(state, action)
+                assert row == model.transition_matrix.get_row_group_start(state) + action
+                expected = {}
+                for entry in model.transition_matrix.get_row(row):
+                    expected.setdefault(model.get_observation(entry.column), {})[entry.column] = entry.value()
+                observations = transitions.get_observations(row)
+                assert observations == sorted(expected.keys())
+                for observation in observations:
+                    successors = transitions.get_successors(row, observation)
+                    assert dict(successors) == expected[observation]
+                    nr_entries += len(successors)
+        assert nr_entries == model.nr_transitions
+        assert transitions.get_successors(0, max(model.get_observation(state) for state in range(model.nr_states)) + 1) == []
@@ -0,0 +1,111 @@
+import stormpy
+
+from configurations import pomdp
+
+from helpers.helper import get_example_path
+
+import math
+
+
+@pomdp
+class TestPomdpTransformations:
+    def test_unfold_memory_reachable(self):
+        program = stormpy.parse_prism_program(get_example_path("pomdp", "maze_2.prism"))
+        formulas = stormpy.parse_properties_for_prism_program("Pmax=? [ !\"bad\" U \"goal\" ]", program)
+        model = stormpy.build_model(program, formulas)
+        model = stormpy.pomdp.make_canonic(model)
+        memory = stormpy.pomdp.PomdpMemoryBuilder().build(stormpy.pomdp.PomdpMemoryPattern.fixed_counter, 3)
+        product = stormpy.pomdp.unfold_memory_reachable(model, memory, add_memory_labels=True, threads=2)
+        assert product.full_product_states == model.nr_states * 3
+        assert product.pomdp.nr_states == len(product.state_origins) == len(product.memory_origins)
+        assert 0 <= product.size_reduction < 1
+        assert product.pomdp.labeling.contains_label("memstate_0")
+        for state in range(product.pomdp.nr_states):
+            assert product.pomdp.get_observation(state) == model.get_observation(product.state_origins[state]) * 3 + product.memory_origins[state]
+
+        # The product coincides with the product built by unfold_memory
+        full = stormpy.pomdp.unfold_memory(model, memory)
+        assert product.pomdp.nr_states == full.nr_states
+        assert product.pomdp.nr_choices == full.nr_choices
+        result = stormpy.model_checking(product.pomdp, formulas[0], force_fully_observable=True)
+        full_result = stormpy.model_checking(full, formulas[0], force_fully_observable=True)
+        assert math.isclose(result.at(product.pomdp.initial_states[0]), full_result.at(full.initial_states[0]), rel_tol=1e-6)
+
+    def test_incremental_observation_trace_unfolder(self):
+        program = stormpy.parse_prism_program(get_example_path("pomdp", "maze_2.prism"))
+        model = stormpy.build_model(program)
+        model = stormpy.pomdp.make_canonic(model)
+        bad_states = model.labeling.get_states("bad")
+        risk = [1.0 if bad_states.get(state) else 0.0 for state in range(model.nr_states)]
+        initial_state = model.initial_states[0]
+        row = model.transition_matrix.get_row_group_start(initial_state)
+        successor = next(iter(model.transition_matrix.get_row(row))).column
+        observation = model.get_observation(successor)
+
+        unfolder = stormpy.pomdp.IncrementalObservationTraceUnfolder(model, risk)
+        lower, upper = unfolder.reset(model.get_observation(initial_state))
+        assert unfolder.layer_states == [initial_state]
+        assert lower == upper == risk[initial_state]
+        lower, upper = unfolder.extend(observation)
+        assert 0 <= lower <= upper <= 1
+        assert unfolder.is_consistent
+        assert unfolder.trace == [model.get_observation(initial_state), observation]
+        assert len(unfolder.latencies) == 2
+        assert successor in unfolder.layer_states
+        assert all(model.get_observation(state) == observation for state in unfolder.layer_states)
+
+        impossible = max(model.get_observation(state) for state in range(model.nr_states)) + 1
+        lower, upper = unfolder.extend(impossible)
+        assert not unfolder.is_consistent
+        assert math.isnan(lower) and math.isnan(upper)
+
+    def test_incremental_observation_trace_unfolder_exact(self):
+        # With a single action in every state, the bounds coincide with the risk computed on the unfolding of the trace
+        program = stormpy.parse_prism_program(get_example_path("pomdp", "noisy_sensor.prism"))
+        model = stormpy.build_model(program)
+        model = stormpy.pomdp.make_canonic(model)
+        critical_states = model.labeling.get_states("critical")
+        risk = [1.0 if critical_states.get(state) else 0.0 for state in range(model.nr_states)]
+        assert model.nr_observations == 2
+        quiet = model.get_observation(model.initial_states[0])
+        alarm = 1 - quiet
+        trace = [quiet, alarm, alarm, quiet, alarm, alarm, alarm]
+
+        unfolder = stormpy.pomdp.IncrementalObservationTraceUnfolder(model, risk)
+        unfolder.reset(trace[0])
+        reference_unfolder = stormpy.pomdp.ObservationTraceUnfolderDouble(model, risk, stormpy.ExpressionManager())
+        properties = stormpy.parse_properties("Pmax=? [F \"_goal\"]")
+        for length in range(2, len(trace) + 1):
+            lower, upper = unfolder.extend(trace[length - 1])
+            unfolding = reference_unfolder.transform(trace[:length])
+            result = stormpy.model_checking(unfolding, properties[0])
+            reference = result.at(unfolding.initial_states[0])
+            assert math.isclose(lower, upper, rel_tol=1e-9, abs_tol=1e-12)
+            assert math.isclose(lower, reference, rel_tol=1e-6, abs_tol=1e-9)
+
+    def test_incremental_observation_trace_unfolder_sound(self):
+        # With several actions, the bounds enclose the risk computed on the unfolding of the trace for all schedulers
+        program = stormpy.parse_prism_program(get_example_path("pomdp", "maze_2.prism"))
+        model = stormpy.build_model(program)
+        model = stormpy.pomdp.make_canonic(model)
+        bad_states = model.labeling.get_states("bad")
+        risk = [1.0 if bad_states.get(state) else 0.0 for state in range(model.nr_states)]
+        # Trace of a path which always takes the last transition of the last action
+        state = model.initial_states[0]
+        trace = [model.get_observation(state)]
+        for _ in range(5):
+            row = model.transition_matrix.get_row_group_end(state) - 1
+            state = list(model.transition_matrix.get_row(row))[-1].column
+            trace.append(model.get_observation(state))
+
+        unfolder = stormpy.pomdp.IncrementalObservationTraceUnfolder(model, risk)
+        unfolder.reset(trace[0])
+        reference_unfolder = stormpy.pomdp.ObservationTraceUnfolderDouble(model, risk, stormpy.ExpressionManager())
+        properties = stormpy.parse_properties("Pmax=? [F \"_goal\"]")
+        for length in range(2, len(trace) + 1):
+            lower, upper = unfolder.extend(trace[length - 1])
+            assert unfolder.is_consistent
+            unfolding = reference_unfolder.transform(trace[:length])
+            result = stormpy.model_checking(unfolding, properties[0])
+            reference = result.at(unfolding.initial_states[0])
+            assert lower - 1e-9 <= reference <= upper + 1e-9
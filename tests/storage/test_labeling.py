@@ -1,5 +1,6 @@
 import stormpy
 from helpers.helper import get_example_path
+from configurations import numpy_avail
 
 
 class TestStateLabeling:
@@ -33,6 +34,43 @@ class TestStateLabeling:
         assert "one" in model.labels_state(7)
         assert "one" in labeling.get_labels_of_state(7)
 
+    @numpy_avail
+    def test_label_matrix(self):
+        program = stormpy.parse_prism_program(get_example_path("dtmc", "die.pm"))
+        model = stormpy.build_model(program)
+        labeling = model.labeling
+        labels = labeling.get_label_list()
+        assert labels == sorted(labeling.get_labels())
+        matrix = labeling.to_matrix()
+        assert matrix.shape == (model.nr_states, len(labels))
+        packed = labeling.to_packed_bitsets()
+        assert packed.shape == (len(labels), 1)
+        for state in range(model.nr_states):
+            for label_id, label in enumerate(labels):
+                has_label = labeling.has_state_label(label, state)
+                assert matrix[state, label_id] == has_label
+                assert bool((int(packed[label_id, state // 64]) >> (state % 64)) & 1) == has_label
+
+        one_id = labeling.get_label_id("one")
+        assert labels[one_id] == "one"
+        assert labeling.get_label_ids(["one", "two"]) == [one_id, labeling.get_label_id("two")]
+        assert list(labeling.to_matrix(["one", "init"])[7]) == [True, False]
+
+        index = labeling.get_label_index()
+        assert index.labels == labels
+        assert index.get_label_ids(["one", "two"]) == labeling.get_label_ids(["one", "two"])
+        assert one_id in index.get_label_ids_of_item(7)
+        for state in range(model.nr_states):
+            assert index.get_label_ids_of_item(state) == [label_id for label_id, label in enumerate(labels) if labeling.has_state_label(label, state)]
+        assert index.get_items(one_id) == labeling.get_states("one")
+        two_id = index.get_label_id("two")
+        states = index.get_items_with_label_ids([one_id, two_id])
+        assert states.number_of_set_bits() == 2
+        assert index.get_items_with_label_ids([one_id, two_id], require_all=True).number_of_set_bits() == 0
+        # The index is a snapshot of the labeling
+        labeling.add_label("a_new_label")
+        assert index.labels == labels
+
     def test_label_parametric(self):
         program = stormpy.parse_prism_program(get_example_path("pdtmc", "brp16_2.pm"))
         formulas = stormpy.parse_properties_for_prism_program("P=? [ F s=5 ]", program)
@@ -158,3 +158,116 @@ class TestMatrix:
         assert submatrix.nr_entries == 10
         for e in submatrix:
             assert e.value() == 0.5 or e.value() == 0 or (e.value() == 1 and e.column > 3)
+
+    def test_sliced_matrix(self):
+        model = stormpy.build_sparse_model_from_explicit(get_example_path("mdp", "two_dice.tra"),
+                                                         get_example_path("mdp", "two_dice.lab"))
+        matrix = model.transition_matrix
+        sliced = stormpy.SlicedSparseMatrix(matrix)
+        assert sliced.nr_rows == 254
+        assert sliced.nr_columns == model.nr_states
+        assert sliced.nr_entries == 436
+        assert sliced.nr_row_groups == model.nr_states
+        assert sliced.nr_padded_entries >= sliced.nr_entries
+        assert sliced.nr_padded_entries % stormpy.SlicedSparseMatrix.slice_height == 0
+
+        x = [0.01 * i for i in range(model.nr_states)]
+        summand = [1.0] * matrix.nr_rows
+        row_result = sliced.multiply(x, summand)
+        assert len(row_result) == matrix.nr_rows
+        for direction in [stormpy.OptimizationDirection.Minimize, stormpy.OptimizationDirection.Maximize]:
+            expected = stormpy.storage._multiply_and_reduce_double(matrix, direction, x, summand)
+            result = sliced.multiply_and_reduce(direction, x, summand)
+            assert len(result) == model.nr_states
+            for value, expected_value in zip(result, expected):
+                assert math.isclose(value, expected_value)
+
+    def test_sliced_matrix_value_iteration(self):
+        model = stormpy.build_sparse_model_from_explicit(get_example_path("dtmc", "die.tra"),
+                                                         get_example_path("dtmc", "die.lab"))
+        sliced = stormpy.SlicedSparseMatrix(model.transition_matrix)
+        target = model.labeling.get_states("one")
+        initial_values = [1.0 if target.get(s) else 0.0 for s in range(model.nr_states)]
+        result = sliced.solve_min_max_equations(stormpy.OptimizationDirection.Maximize, [0.0] * model.nr_states, initial_values,
+                                                precision=1e-8)
+        assert result.converged
+        assert result.iterations > 1
+        assert math.isclose(result.values[model.initial_states[0]], 1 / 6, rel_tol=1e-6)
+
+    def test_sliced_matrix_index_size(self):
+        model = stormpy.build_sparse_model_from_explicit(get_example_path("mdp", "two_dice.tra"),
+                                                         get_example_path("mdp", "two_dice.lab"))
+        matrix = model.transition_matrix
+        sliced32 = stormpy.build_sliced_matrix(matrix)
+        assert type(sliced32) is stormpy.SlicedSparseMatrix
+        assert sliced32.index_bits == 32
+        sliced64 = stormpy.build_sliced_matrix(matrix, index_bits=64)
+        assert type(sliced64) is stormpy.SlicedSparseMatrix64
+        assert sliced64.index_bits == 64
+        assert sliced32.nr_padded_entries == sliced64.nr_padded_entries
+        assert sliced32.size_in_memory < sliced64.size_in_memory
+        assert sliced32.size_in_memory < matrix.size_in_memory
+
+        x = [0.01 * i for i in range(model.nr_states)]
+        result32 = sliced32.multiply_and_reduce(stormpy.OptimizationDirection.Maximize, x)
+        result64 = sliced64.multiply_and_reduce(stormpy.OptimizationDirection.Maximize, x)
+        for value32, value64 in zip(result32, result64):
+            assert math.isclose(value32, value64)
+
+    def test_sliced_matrix_float(self):
+        model = stormpy.build_sparse_model_from_explicit(get_example_path("mdp", "two_dice.tra"),
+                                                         get_example_path("mdp", "two_dice.lab"))
+        matrix = model.transition_matrix
+        sliced_double = stormpy.build_sliced_matrix(matrix)
+        sliced_float = stormpy.build_sliced_matrix(matrix, value_bits=32)
+        assert type(sliced_float) is stormpy.FloatSlicedSparseMatrix
+        assert sliced_float.value_bits == 32
+        assert sliced_float.size_in_memory < sliced_double.size_in_memory
+
+        x = [0.01 * i for i in range(model.nr_states)]
+        result_double = sliced_double.multiply_and_reduce(stormpy.OptimizationDirection.Minimize, x)
+        result_float = sliced_float.multiply_and_reduce(stormpy.OptimizationDirection.Minimize, x)
+        for value_float, value_double in zip(result_float, result_double):
+            assert math.isclose(value_float, value_double, rel_tol=1e-5, abs_tol=1e-6)
+
+    def test_mixed_precision_value_iteration(self):
+        model = stormpy.build_sparse_model_from_explicit(get_example_path("dtmc", "die.tra"),
+                                                         get_example_path("dtmc", "die.lab"))
+        target = model.labeling.get_states("one")
+        done = model.labeling.get_states("done")
+        initial_values = [1.0 if target.get(s) else 0.0 for s in range(model.nr_states)]
+        # The bounds fix the values of the absorbing states
+        upper_bound = [0.0 if done.get(s) and not target.get(s) else 1.0 for s in range(model.nr_states)]
+        result = stormpy.solve_min_max_equations_mixed_precision(model.transition_matrix, stormpy.OptimizationDirection.Maximize,
+                                                                 [0.0] * model.nr_states, initial_values, precision=1e-10,
+                                                                 lower_bound=initial_values, upper_bound=upper_bound)
+        assert result.certified
+        assert result.approximate_iterations > 1
+        assert result.refinement_iterations >= 1
+        assert result.error_bound <= 1e-10
+        initial_state = model.initial_states[0]
+        assert result.lower_values[initial_state] <= 1 / 6 <= result.upper_values[initial_state]
+        assert math.isclose(result.values[initial_state], 1 / 6, rel_tol=1e-9)
+
+    def test_mixed_precision_value_iteration_certified(self):
+        # x = 0.999 * x + 0.001 has the solution 1, but consecutive iterates of value iteration differ only slightly long before
+        builder = stormpy.SparseMatrixBuilder(1, 1, force_dimensions=False)
+        builder.add_next_value(0, 0, 0.999)
+        matrix = builder.build()
+        sliced = stormpy.build_sliced_matrix(matrix)
+        naive = sliced.solve_min_max_equations(stormpy.OptimizationDirection.Maximize, [0.001], [0.0], precision=1e-6)
+        assert naive.converged
+        assert 1 - naive.values[0] > 1e-4
+
+        result = stormpy.solve_min_max_equations_mixed_precision(matrix, stormpy.OptimizationDirection.Maximize, [0.001], [0.0], precision=1e-6)
+        assert result.certified
+        assert result.error_bound <= 1e-6
+        assert result.lower_values[0] <= 1 <= result.upper_values[0]
+        assert math.isclose(result.values[0], 1, rel_tol=1e-6)
+
+        # The bounds do not close within the iteration limit
+        result = stormpy.solve_min_max_equations_mixed_precision(matrix, stormpy.OptimizationDirection.Maximize, [0.001], [0.0], precision=1e-6,
+                                                                 maximal_iterations=100)
+        assert not result.certified
+        assert result.error_bound > 1e-6
+        assert result.lower_values[0] <= 1 <= result.upper_values[0]
@@ -1,5 +1,7 @@
 import stormpy
+import pytest
 from helpers.helper import get_example_path
+from configurations import numpy_avail
 
 
 class TestMaximalEndComponents:
@@ -51,3 +53,75 @@ class TestMaximalEndComponents:
                         for transition in action.transitions:
                             assert transition.value() == 1
                             assert 1 <= transition.column <= 13
+
+    @numpy_avail
+    def test_parallel_decomposition(self):
+        import numpy as np
+        program = stormpy.parse_prism_program(get_example_path("mdp", "maze_2.nm"))
+        model = stormpy.build_model(program)
+        decomposition = stormpy.get_maximal_end_components(model)
+
+        for threads in [1, 4]:
+            result = stormpy.get_maximal_end_components_parallel(model, threads)
+            assert result.nr_components == decomposition.size
+            assert len(result.state_components) == model.nr_states
+            assert len(result.choice_components) == model.nr_choices
+            for mec in decomposition:
+                states = [state for state, _ in mec]
+                index = result.state_components[states[0]]
+                assert index >= 0
+                assert sorted(np.flatnonzero(result.state_components == index)) == sorted(states)
+                choices = sorted(choice for _, state_choices in mec for choice in state_choices)
+                assert sorted(np.flatnonzero(result.choice_components == index)) == choices
+
+    @numpy_avail
+    def test_parallel_scc_decomposition(self):
+        import numpy as np
+        model = stormpy.build_sparse_model_from_explicit(get_example_path("dtmc", "die.tra"),
+                                                         get_example_path("dtmc", "die.lab"))
+        result = stormpy.get_strongly_connected_components_parallel(model, 2)
+        assert len(result.state_components) == model.nr_states
+        assert len(result.choice_components) == 0
+        assert np.all(result.state_components >= 0)
+        # States 1,3 and 2,6 form cycles, all other states are singleton SCCs
+        assert result.nr_components == 11
+        assert result.state_components[1] == result.state_components[3]
+        assert result.state_components[2] == result.state_components[6]
+        assert result.state_components[1] != result.state_components[2]
+        # Views on internal data are read-only
+        assert not result.state_components.flags.writeable
+        with pytest.raises(ValueError):
+            result.state_components[0] = 0
+
+    @numpy_avail
+    def test_flat_decomposition(self):
+        program = stormpy.parse_prism_program(get_example_path("mdp", "maze_2.nm"))
+        model = stormpy.build_model(program)
+        decomposition = stormpy.get_maximal_end_components(model)
+        flat = decomposition.flatten()
+        assert flat.nr_components == decomposition.size
+        assert len(flat.offsets) == decomposition.size + 1
+        assert len(flat.choice_offsets) == decomposition.size + 1
+        for i, mec in enumerate(decomposition):
+            states = flat.states[flat.offsets[i]:flat.offsets[i + 1]]
+            choices = flat.choices[flat.choice_offsets[i]:flat.choice_offsets[i + 1]]
+            assert list(states) == sorted(state for state, _ in mec)
+            assert list(choices) == sorted(choice for _, state_choices in mec for choice in state_choices)
+
+    @numpy_avail
+    def test_scc_decomposition(self):
+        model = stormpy.build_sparse_model_from_explicit(get_example_path("dtmc", "die.tra"),
+                                                         get_example_path("dtmc", "die.lab"))
+        sccs = stormpy.get_strongly_connected_components(model)
+        assert sccs.size == 11
+        assert sum(scc.size for scc in sccs) == model.nr_states
+        nontrivial = stormpy.get_strongly_connected_components(model, drop_naive_sccs=True)
+        assert nontrivial.size == 8
+
+        bsccs = stormpy.get_bottom_strongly_connected_components(model)
+        assert bsccs.size == 6
+        flat = bsccs.flatten()
+        assert flat.nr_components == 6
+        assert list(flat.offsets) == list(range(7))
+        assert sorted(flat.states) == list(range(7, 13))
+        assert len(flat.choices) == 0
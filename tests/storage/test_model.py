@@ -1,5 +1,6 @@
 import stormpy
 from helpers.helper import get_example_path
+from configurations import numpy_avail
 import pytest
 
 
@@ -55,6 +56,67 @@ class TestSparseModel:
             assert reward == 1.0 or reward == 0.0
         assert not model.reward_models["coin_flips"].has_transition_rewards
 
+    @numpy_avail
+    def test_reward_arrays(self):
+        import numpy as np
+        program = stormpy.parse_prism_program(get_example_path("dtmc", "die.pm"))
+        properties = stormpy.parse_properties_for_prism_program("R=? [F \"done\"]", program, None)
+        model = stormpy.build_model(program, properties)
+        reward_model = model.get_reward_model("coin_flips")
+        rewards = reward_model.state_action_reward_array
+        assert len(rewards) == model.nr_choices
+        assert list(rewards) == reward_model.state_action_rewards
+        # The array is a view on the reward model
+        rewards[0] = 2.0
+        assert reward_model.get_state_action_reward(0) == 2.0
+        with pytest.raises(stormpy.StormError):
+            reward_model.state_reward_array
+
+        state_rewards = np.arange(model.nr_states, dtype=float)
+        new_reward_model = stormpy.SparseRewardModel.from_arrays(state_rewards=state_rewards)
+        assert new_reward_model.has_state_rewards
+        assert not new_reward_model.has_state_action_rewards
+        model.add_reward_model("index", new_reward_model)
+        assert list(model.get_reward_model("index").state_reward_array) == list(state_rewards)
+
+    @numpy_avail
+    def test_substitute_transition_values(self):
+        import numpy as np
+        program = stormpy.parse_prism_program(get_example_path("dtmc", "die.pm"))
+        model = stormpy.build_model(program)
+        values = model.transition_matrix.value_array
+        assert len(values) == model.nr_transitions
+        # The view on the matrix cannot be modified
+        with pytest.raises(ValueError):
+            values[0] = 0.5
+        # Replace the fair coin by a biased one
+        new_values = values.copy()
+        new_values[new_values == 0.5] = np.tile([0.25, 0.75], np.count_nonzero(values == 0.5) // 2)
+        new_model = model.substitute_transition_values(new_values)
+        assert type(new_model) is stormpy.SparseDtmc
+        assert new_model.nr_states == model.nr_states
+        assert new_model.labeling.get_labels() == model.labeling.get_labels()
+        assert list(new_model.transition_matrix.value_array) == list(new_values)
+        # The original model is unchanged
+        assert list(model.transition_matrix.value_array) == list(values)
+        with pytest.raises(stormpy.StormError):
+            model.substitute_transition_values(new_values[1:])
+        # Rows must be probability distributions
+        invalid_values = new_values.copy()
+        invalid_values[0] += 0.5
+        with pytest.raises(stormpy.StormError):
+            model.substitute_transition_values(invalid_values)
+
+    @numpy_avail
+    def test_substitute_transition_values_pomdp(self):
+        program = stormpy.parse_prism_program(get_example_path("pomdp", "maze_2.prism"))
+        formulas = stormpy.parse_properties_for_prism_program("P=? [F \"goal\"]", program)
+        model = stormpy.build_model(program, formulas)
+        new_model = model.substitute_transition_values(model.transition_matrix.value_array)
+        assert type(new_model) is stormpy.SparsePomdp
+        assert new_model.nr_observations == model.nr_observations
+        assert list(new_model.observations) == list(model.observations)
+
     def test_build_dtmc_from_jani_model(self):
         jani_model, properties = stormpy.parse_jani_model(get_example_path("dtmc", "die.jani"))
         model = stormpy.build_model(jani_model)
@@ -34,3 +34,20 @@ class TestPrism:
         module = program.modules[0]
         assert len(module.integer_variables) == 2
         assert len(module.boolean_variables) == 0
+
+    def test_slice_prism_program(self):
+        program = stormpy.parse_prism_program(get_example_path("ctmc", "embedded2.sm"))
+        properties = stormpy.parse_properties_for_prism_program("P=? [ F<=86400 \"fail_sensors\" ]", program)
+        result = stormpy.slice_prism_program(program, properties)
+        assert sorted(result.removed_variables) == ["a", "comp", "count", "m", "o", "reqi", "reqo"]
+        assert result.nr_removed_commands == 9
+        assert result.state_space_reduction_bound == 576
+        assert not result.program.has_label("down")
+
+        model = stormpy.build_model(program, properties)
+        sliced_model = stormpy.build_model(result.program, properties)
+        assert sliced_model.nr_states < model.nr_states
+        assert sliced_model.nr_states <= 12
+        value = stormpy.model_checking(model, properties[0]).at(model.initial_states[0])
+        sliced_value = stormpy.model_checking(sliced_model, properties[0]).at(sliced_model.initial_states[0])
+        assert value == pytest.approx(sliced_value)
@@ -2,7 +2,8 @@ import stormpy
 from helpers.helper import get_example_path
 
 import math
-from configurations import spot
+import pytest
+from configurations import numpy_avail, spot
 
 
 class TestScheduler:
@@ -89,6 +90,52 @@ class TestScheduler:
         for state in intermediate.states:
             assert len(state.actions) == 1
 
+    @numpy_avail
+    def test_scheduler_arrays(self):
+        import numpy as np
+        program = stormpy.parse_prism_program(get_example_path("mdp", "coin2-2.nm"))
+        formulas = stormpy.parse_properties_for_prism_program("Pmin=? [ F \"finished\" & \"all_coins_equal_1\"]", program)
+        model = stormpy.build_model(program, formulas)
+        result = stormpy.model_checking(model, formulas[0], extract_scheduler=True)
+        scheduler = result.scheduler
+        choices = scheduler.to_choice_array()
+        assert len(choices) == model.nr_states
+        for state in model.states:
+            assert choices[state.id] == scheduler.get_choice(state).get_deterministic_choice()
+        imported = stormpy.Scheduler.from_choice_array(choices)
+        assert imported.memoryless
+        assert imported.deterministic
+        assert np.array_equal(imported.to_choice_array(), choices)
+
+        offsets, dist_choices, probabilities = scheduler.to_distribution_arrays()
+        assert len(offsets) == model.nr_states + 1
+        assert np.array_equal(dist_choices, choices)
+        assert np.all(probabilities == 1.0)
+        randomized = stormpy.Scheduler.from_distribution_arrays([0, 2] + [2 + i for i in range(1, model.nr_states)], [0, 1] + [0] * (model.nr_states - 1),
+                                                                [0.5, 0.5] + [1.0] * (model.nr_states - 1))
+        assert not randomized.deterministic
+        with pytest.raises(stormpy.StormError):
+            randomized.to_choice_array()
+        # Distributions must be non-negative and sum up to one
+        offsets = [0, 2] + [2 + i for i in range(1, model.nr_states)]
+        dist_choices = [0, 1] + [0] * (model.nr_states - 1)
+        with pytest.raises(stormpy.StormError):
+            stormpy.Scheduler.from_distribution_arrays(offsets, dist_choices, [1.5, -0.5] + [1.0] * (model.nr_states - 1))
+        with pytest.raises(stormpy.StormError):
+            stormpy.Scheduler.from_distribution_arrays(offsets, dist_choices, [0.5, 0.4] + [1.0] * (model.nr_states - 1))
+
+    def test_induced_dtmc(self):
+        program = stormpy.parse_prism_program(get_example_path("mdp", "coin2-2.nm"))
+        formulas = stormpy.parse_properties_for_prism_program("Pmin=? [ F \"finished\" & \"all_coins_equal_1\"]", program)
+        model = stormpy.build_model(program, formulas)
+        result = stormpy.model_checking(model, formulas[0], extract_scheduler=True)
+        induced = stormpy.InducedDtmc(model, result.scheduler)
+        assert induced.nr_states == model.nr_states
+        assert induced.transition_matrix.nr_rows == model.nr_states
+        target = model.labeling.get_states("finished") & model.labeling.get_states("all_coins_equal_1")
+        probabilities = induced.compute_reachability_probabilities(target, precision=1e-10)
+        assert math.isclose(probabilities[model.initial_states[0]], result.at(model.initial_states[0]), rel_tol=1e-6)
+
     @spot
     def test_apply_scheduler_mdp_ltl(self):
         program = stormpy.parse_prism_program(get_example_path("mdp", "slipgrid.nm"))
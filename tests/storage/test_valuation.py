@@ -0,0 +1,63 @@
+import pytest
+import stormpy
+import stormpy.examples
+import stormpy.examples.files
+from configurations import numpy_avail
+
+
+@numpy_avail
+class TestStateValuationTable:
+    def _build_die(self):
+        program = stormpy.parse_prism_program(stormpy.examples.files.prism_dtmc_die)
+        options = stormpy.BuilderOptions()
+        options.set_build_state_valuations()
+        model = stormpy.build_sparse_model_with_options(program, options)
+        module = program.modules[0]
+        return model, module.get_integer_variable("s").expression_variable, module.get_integer_variable("d").expression_variable
+
+    def test_columns(self):
+        model, s_var, d_var = self._build_die()
+        table = stormpy.get_state_valuation_table(model)
+        assert table.nr_states == model.nr_states
+        assert len(table.variables) == 2
+        s_values = table.get_column(s_var)
+        d_values = table.get_column(d_var)
+        assert len(s_values) == model.nr_states
+        for state in range(model.nr_states):
+            assert s_values[state] == model.state_valuations.get_integer_value(state, s_var)
+            assert d_values[state] == model.state_valuations.get_integer_value(state, d_var)
+
+        subset = stormpy.BitVector(model.nr_states, [0, 5])
+        assert list(table.get_column(s_var, subset)) == [s_values[0], s_values[5]]
+
+    def test_reverse_index(self):
+        model, s_var, d_var = self._build_die()
+        table = stormpy.get_state_valuation_table(model)
+        assert stormpy.get_state_valuation_table(model) is table
+        done = table.get_states(s_var, 7)
+        assert len(done) == 6
+        for state in done:
+            assert model.state_valuations.get_integer_value(int(state), s_var) == 7
+        assert list(table.get_states(d_var, 3)) == [state for state in range(model.nr_states)
+                                                     if model.state_valuations.get_integer_value(state, d_var) == 3]
+        assert len(table.get_states(s_var, 42)) == 0
+
+    def test_lookup(self):
+        import numpy as np
+        model, s_var, d_var = self._build_die()
+        table = stormpy.get_state_valuation_table(model)
+        queries = np.array([[3, 0], [7, 3], [7, 0], [0, 0]])
+        states = table.lookup(queries, [s_var, d_var])
+        assert len(states) == 4
+        assert model.state_valuations.get_integer_value(int(states[0]), s_var) == 3
+        assert model.state_valuations.get_integer_value(int(states[1]), d_var) == 3
+        assert states[2] == -1
+        assert states[3] == model.initial_states[0]
+
+        # Variables in the order of the table
+        all_values = np.column_stack([table.get_column(var) for var in table.variables])
+        assert list(table.lookup(all_values)) == list(range(model.nr_states))
+
+        # Variable s alone does not identify the states
+        with pytest.raises(stormpy.StormError):
+            table.lookup(np.array([[7]]), [s_var])
@@ -5,6 +5,7 @@ from stormpy.utility import MatrixFormat
 from helpers.helper import get_example_path
 
 import pytest
+from configurations import numpy_avail
 import math
 
 
@@ -143,3 +144,18 @@ class TestShortestPaths:
     def test_spg_state_list(self, model, target_label, index, expected_path):
         spg = ShortestPathsGenerator(model, target_label)
         assert spg.get_path_as_list(index) == expected_path(index)
+
+    @numpy_avail
+    def test_k_shortest_paths_batched(self, model, target_label, state_bitvector, expected_distance, expected_path):
+        targets = model.labeling.get_states(target_label)
+        results = stormpy.utility.compute_k_shortest_paths(model, [targets, state_bitvector], 10, threads=2)
+        assert len(results) == 2
+        result = results[0]
+        assert result.nr_paths == 10
+        assert len(result.offsets) == 11
+        for index in range(1, 11):
+            assert math.isclose(result.distances[index - 1], expected_distance(index))
+            assert result.get_path(index - 1) == list(reversed(expected_path(index)))
+        spg = ShortestPathsGenerator(model, state_bitvector)
+        for index in range(1, results[1].nr_paths + 1):
+            assert math.isclose(results[1].distances[index - 1], spg.get_distance(index))